@@ -0,0 +1,378 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sudoku.h"
+#include "solver_pool.h"
+#include "speculate.h"
+#include "pipeline.h"
+#include "corpus.h"
+#include "checkpoint.h"
+
+// This is the entry point for the solve-batch mode: instead of the
+//   interactive game loop in main.c, it streams line-delimited 81-character
+//   puzzles from stdin (or from a file passed as the first argument), solves
+//   each one with sudoku_solve, and writes the result to stdout. With
+//   "--threads N" the puzzles are sharded across a work-stealing pool of N
+//   worker threads; otherwise a single board is allocated once and reused
+//   for every puzzle, so there is no per-puzzle allocation.
+
+// the shared description of one generation run, handed to every generator
+//   thread
+struct generate_job {
+  // remaining counts the puzzles still to be generated, claimed one at a
+  //   time under lock
+  int remaining;
+  int target_clues;
+  unsigned int seed;
+  pthread_mutex_t lock;
+};
+
+// generate_main(arg) is the body of one generator thread: it claims puzzles
+//   from the shared job, generates each on its own board, and prints them as
+//   compact one-line puzzles.
+// effects: produces output
+//          mutates the job
+static void *generate_main(void *arg) {
+  assert(arg);
+  struct generate_job *job = arg;
+
+  struct sudoku *su = malloc(sudoku_size());
+  assert(su);
+
+  while (1) {
+    pthread_mutex_lock(&job->lock);
+    if (job->remaining == 0) {
+      pthread_mutex_unlock(&job->lock);
+      break;
+    }
+    --job->remaining;
+    // every puzzle gets its own seed so threads do not repeat each other
+    unsigned int seed = job->seed;
+    ++job->seed;
+    pthread_mutex_unlock(&job->lock);
+
+    sudoku_generate(su, job->target_clues, seed);
+
+    pthread_mutex_lock(&job->lock);
+    solution_print_compact(su);
+    pthread_mutex_unlock(&job->lock);
+  }
+
+  free(su);
+  return NULL;
+}
+
+// run_generate(count, target_clues, threads) generates count puzzles across
+//   the given number of threads and prints them one per line.
+// effects: produces output
+static void run_generate(int count, int target_clues, int threads) {
+  struct generate_job job;
+  job.remaining = count;
+  job.target_clues = target_clues;
+  job.seed = (unsigned int)time(NULL);
+  pthread_mutex_init(&job.lock, NULL);
+
+  pthread_t workers[32];
+  if (threads > 32) {
+    threads = 32;
+  }
+  for (int i = 0; i < threads; ++i) {
+    assert(pthread_create(&workers[i], NULL, generate_main, &job) == 0);
+  }
+  for (int i = 0; i < threads; ++i) {
+    pthread_join(workers[i], NULL);
+  }
+  pthread_mutex_destroy(&job.lock);
+}
+
+int main(int argc, char *argv[]) {
+  // define and initialize the number of worker threads; 1 means solving
+  //   happens inline on the main thread
+  int threads = 1;
+  // define and initialize a flag selecting the one-line output format for
+  //   machine consumption instead of the drawn board
+  bool compact = false;
+  // define and initialize the path of a packed binary corpus to solve
+  //   instead of text puzzles from stdin
+  const char *corpus_path = NULL;
+  // define and initialize the number of puzzles to generate; 0 means the
+  //   normal solving modes run instead
+  int generate = 0;
+  // define and initialize the clue target for generated puzzles
+  int target_clues = 28;
+  // define and initialize the size of the transposition cache in entries;
+  //   0 leaves caching off
+  long cache_entries = 0;
+  // define and initialize the path periodic progress checkpoints are
+  //   written to; NULL disables checkpointing
+  const char *checkpoint_path = NULL;
+  // define and initialize a flag requesting that a saved checkpoint be
+  //   loaded and the corpus run continued from it
+  bool resume = false;
+  // define and initialize a flag selecting rating mode: puzzles are
+  //   classified by solver effort instead of printed as solutions
+  bool rate = false;
+  // define and initialize a flag selecting intra-puzzle parallelism: the
+  //   threads race over the candidates of one puzzle's first branch cell
+  //   instead of sharding puzzles across a pool
+  bool speculate = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--compact") == 0) {
+      compact = true;
+    } else if (strcmp(argv[i], "--speculate") == 0) {
+      speculate = true;
+    } else if (strcmp(argv[i], "--rate") == 0) {
+      rate = true;
+    } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+      checkpoint_path = argv[i + 1];
+      ++i;
+    } else if (strcmp(argv[i], "--resume") == 0) {
+      resume = true;
+    } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+      cache_entries = atol(argv[i + 1]);
+      if (cache_entries < 1) {
+        printf("ERROR: --cache requires a positive entry count\n");
+        return EXIT_FAILURE;
+      }
+      ++i;
+    } else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+      generate = atoi(argv[i + 1]);
+      ++i;
+    } else if (strcmp(argv[i], "--clues") == 0 && i + 1 < argc) {
+      target_clues = atoi(argv[i + 1]);
+      ++i;
+    } else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+      corpus_path = argv[i + 1];
+      ++i;
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = atoi(argv[i + 1]);
+      if (threads < 1) {
+        printf("ERROR: --threads requires a positive number\n");
+        return EXIT_FAILURE;
+      }
+      ++i;
+    } else {
+      // redirect stdin to the given puzzle file so the read path is the same
+      //   whether the puzzles arrive on a pipe or from disk
+      if (!freopen(argv[i], "r", stdin)) {
+        printf("ERROR: cannot open puzzle file %s\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  if (cache_entries > 0 && !sudoku_cache_init(cache_entries)) {
+    printf("ERROR: cannot allocate a %ld-entry cache\n", cache_entries);
+    return EXIT_FAILURE;
+  }
+
+  if (generate > 0) {
+    if (target_clues < 1) {
+      printf("ERROR: --clues requires a positive number\n");
+      return EXIT_FAILURE;
+    }
+    run_generate(generate, target_clues, threads);
+    return EXIT_SUCCESS;
+  }
+
+  // define and initialize counters to report how many puzzles were processed
+  //   and how many of them could be solved
+  int total = 0;
+  int solved = 0;
+
+  // define and initialize the corpus record the run starts from; a resumed
+  //   run picks up the counters and position of the saved checkpoint
+  long start_record = 0;
+  if (checkpoint_path || resume) {
+    if (!corpus_path) {
+      printf("ERROR: --checkpoint and --resume require --corpus\n");
+      return EXIT_FAILURE;
+    }
+  }
+  if (resume) {
+    if (!checkpoint_path) {
+      printf("ERROR: --resume requires --checkpoint\n");
+      return EXIT_FAILURE;
+    }
+    long saved_total = 0;
+    long saved_solved = 0;
+    if (!checkpoint_load(checkpoint_path, &start_record, &saved_total,
+                         &saved_solved)) {
+      printf("ERROR: cannot read checkpoint file %s\n", checkpoint_path);
+      return EXIT_FAILURE;
+    }
+    total = (int)saved_total;
+    solved = (int)saved_solved;
+  }
+
+  if (rate) {
+    // rating mode: one line per puzzle naming its difficulty bucket; the
+    //   analysis is one instrumented solve per puzzle, so a corpus that
+    //   took an external rater hours rates at solver speed
+    if (corpus_path) {
+      struct sudoku *su = malloc(sudoku_size());
+      assert(su);
+      struct corpus *corp = corpus_open(corpus_path);
+      if (!corp) {
+        printf("ERROR: cannot open corpus file %s\n", corpus_path);
+        free(su);
+        return EXIT_FAILURE;
+      }
+      for (long i = 0; i < corpus_count(corp); ++i) {
+        ++total;
+        if (!sudoku_reset_to_cells(su, corpus_record(corp, i))) {
+          printf("ERROR: corpus record %ld is not a valid puzzle\n", i);
+          continue;
+        }
+        printf("%s\n", sudoku_rating_name(sudoku_rate(su)));
+      }
+      corpus_close(corp);
+      free(su);
+    } else {
+      // sudoku_read_next (rather than sudoku_read) makes an empty stream a
+      //   zero-puzzle run instead of a failed assertion
+      struct sudoku *su = sudoku_read_next();
+      if (su) {
+        do {
+          ++total;
+          printf("%s\n", sudoku_rating_name(sudoku_rate(su)));
+        } while (sudoku_read_into(su));
+        sudoku_destroy(su);
+      }
+    }
+
+    printf("Rated %d puzzles.\n", total);
+    return EXIT_SUCCESS;
+  }
+
+  if (corpus_path) {
+    // packed corpus path: the file is mapped once and each record is
+    //   decoded straight from the mapping, so there is no text parsing
+    struct corpus *corp = corpus_open(corpus_path);
+    if (!corp) {
+      printf("ERROR: cannot open corpus file %s\n", corpus_path);
+      return EXIT_FAILURE;
+    }
+
+    if (threads > 1 && !speculate) {
+      struct solver_pool *pool = solver_pool_create(threads, compact);
+      // define and initialize the counter baselines of this run and a
+      //   scratch board for re-checking records, so the periodic
+      //   checkpoints below can report exact record positions
+      int base_total = total;
+      int base_solved = solved;
+      struct sudoku *scratch = malloc(sudoku_size());
+      assert(scratch);
+      for (long i = start_record; i < corpus_count(corp); ++i) {
+        // a checkpoint every so often bounds what a crash can cost here
+        //   too: the pool reports the record index of the last result the
+        //   writer has printed, and printing follows submission order, so
+        //   everything up to that index is fully on disk. Invalid records
+        //   never reach the pool; the ones directly after the printed
+        //   prefix had their error lines reported at submission time, so
+        //   the checkpoint steps past them by re-checking the records
+        //   themselves. The save trails submission by at most the
+        //   in-flight window instead of losing that window on a crash.
+        if (checkpoint_path && i > start_record && (i & 1023) == 0) {
+          long last_record = 0;
+          int pool_solved = 0;
+          solver_pool_progress(pool, &last_record, &pool_solved);
+          long next = last_record < 0 ? start_record : last_record + 1;
+          while (next < i &&
+                 !sudoku_reset_to_cells(scratch, corpus_record(corp, next))) {
+            ++next;
+          }
+          checkpoint_save(checkpoint_path, next,
+                          base_total + (int)(next - start_record),
+                          base_solved + pool_solved);
+        }
+        struct sudoku *su = malloc(sudoku_size());
+        assert(su);
+        ++total;
+        if (!sudoku_reset_to_cells(su, corpus_record(corp, i))) {
+          printf("ERROR: corpus record %ld is not a valid puzzle\n", i);
+          free(su);
+          continue;
+        }
+        solver_pool_submit(pool, su, total, i);
+      }
+      free(scratch);
+      solved += solver_pool_finish(pool);
+    } else {
+      struct sudoku *su = malloc(sudoku_size());
+      assert(su);
+      for (long i = start_record; i < corpus_count(corp); ++i) {
+        // a checkpoint every so often bounds what a crash can cost; record
+        //   i itself has not been solved yet, so it is where a resume
+        //   starts
+        if (checkpoint_path && i > start_record && (i & 1023) == 0) {
+          checkpoint_save(checkpoint_path, i, total, solved);
+        }
+        ++total;
+        if (!sudoku_reset_to_cells(su, corpus_record(corp, i))) {
+          printf("ERROR: corpus record %ld is not a valid puzzle\n", i);
+          continue;
+        }
+        if (speculate ? sudoku_solve_parallel(su, threads)
+                      : sudoku_solve(su)) {
+          ++solved;
+          if (compact) {
+            solution_print_compact(su);
+          } else {
+            solution_print(su);
+          }
+        } else {
+          printf("Could not solve puzzle %d using search and "
+                 "backtracking :(\n", total);
+        }
+      }
+      free(su);
+    }
+    if (checkpoint_path) {
+      // the final checkpoint marks the run complete, so a resume after a
+      //   clean finish solves nothing again
+      checkpoint_save(checkpoint_path, corpus_count(corp), total, solved);
+    }
+    corpus_close(corp);
+  } else if (threads > 1 && !speculate) {
+    // streamed text input goes through the three-stage pipeline: this
+    //   thread reads, a worker pool solves, and a writer thread emits the
+    //   solutions in input order
+    solved = pipeline_run(threads, compact, &total);
+  } else {
+    // sudoku_read_next (rather than sudoku_read) makes an empty stream a
+    //   zero-puzzle run instead of a failed assertion
+    struct sudoku *su = sudoku_read_next();
+    if (su) {
+      do {
+        ++total;
+        if (speculate ? sudoku_solve_parallel(su, threads)
+                      : sudoku_solve(su)) {
+          ++solved;
+          if (compact) {
+            solution_print_compact(su);
+          } else {
+            solution_print(su);
+          }
+        } else {
+          printf("Could not solve puzzle %d using search and backtracking "
+                 ":(\n", total);
+        }
+      } while (sudoku_read_into(su));
+      sudoku_destroy(su);
+    }
+  }
+
+  printf("Solved %d of %d puzzles.\n", solved, total);
+
+#ifdef SUDOKU_PROFILE
+  // dump the hot-path profile of the run; the counters are per-thread, so
+  //   this covers the work done on the main thread (the whole run when
+  //   --threads is 1)
+  sudoku_profile_print();
+#endif
+}
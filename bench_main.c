@@ -0,0 +1,180 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "sudoku.h"
+
+// This is the entry point for the bench mode: it runs microbenchmarks for
+//   sudoku_solve, cell_choices, and cell_hint over a small bundled corpus
+//   (easy, medium, hard, and pathological 17-clue puzzles), with warmup and
+//   repetition, and reports ns/op plus solve-time percentiles. The numbers
+//   printed here are the baseline that solver changes are judged against:
+//   run it before and after a patch and compare.
+
+// === GLOBAL READONLY =====================================================
+
+// WARMUP is the number of unmeasured passes before timing starts
+static const int WARMUP = 2;
+// REPS is the number of measured passes over the corpus
+static const int REPS = 25;
+// MAX_SAMPLES bounds the number of per-solve timings kept for percentiles
+#define MAX_SAMPLES 4096
+
+// the bundled corpus, one 81-character puzzle per entry
+static const char *const EASY[] = {
+  "53__7____6__195____98____6_8___6___34__8_3__17___2___6_6____28____419__5____8__79",
+  "_2_6_8___58___97______4____37____5__6_______4__8____13____2______98___36___3_6_9_",
+};
+static const char *const MEDIUM[] = {
+  "__9748___7_________2_1_9_____7___24__64_1_59__98___3_____8_3_2_________6___2759__",
+  "_2__3____8__4__1____1__67__4______9____5__8____7____3__86__2____3__9__5____1___7_",
+};
+static const char *const HARD[] = {
+  "_______1__4________2_____________5_4_7__8___3____1_9____3__4__2___5_1________8_6_",
+  "4_____8_5_3__________7______2_____6_____8_4______1_______6_3_7_5__2_____1_4______",
+};
+static const char *const PATHOLOGICAL[] = {
+  "______________3_85__1_2_______5_7_____4___1___9_______5______73__2_1________4___9",
+};
+
+// a corpus class is a named group of puzzles benchmarked together
+struct corpus_class {
+  const char *name;
+  const char *const *puzzles;
+  int count;
+};
+
+// now_ns() returns a monotonic timestamp in nanoseconds.
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// cmp_ll(a, b) compares two long long values for qsort.
+static int cmp_ll(const void *a, const void *b) {
+  long long x = *(const long long *)a;
+  long long y = *(const long long *)b;
+  if (x < y) {
+    return -1;
+  }
+  if (x > y) {
+    return 1;
+  }
+  return 0;
+}
+
+// percentile(samples, count, p) returns the p-th percentile of the sorted
+//   samples array.
+// requires: samples is sorted and count is positive
+//           p is between 0 and 100 (both inclusive)
+static long long percentile(const long long samples[], int count, int p) {
+  assert(samples);
+  assert(count > 0);
+
+  int idx = (count - 1) * p / 100;
+  return samples[idx];
+}
+
+// bench_solve(cls, su) benchmarks sudoku_solve over one corpus class and
+//   prints ns/op and solve-time percentiles.
+// effects: produces output
+//          mutates su
+static void bench_solve(const struct corpus_class *cls, struct sudoku *su) {
+  assert(cls);
+  assert(su);
+
+  // define and initialize an array of the individual solve times, for the
+  //   percentile report
+  static long long samples[MAX_SAMPLES];
+  int num_samples = 0;
+
+  for (int rep = 0; rep < WARMUP + REPS; ++rep) {
+    for (int i = 0; i < cls->count; ++i) {
+      assert(sudoku_reset_to(su, cls->puzzles[i]));
+
+      long long start = now_ns();
+      if (!sudoku_solve(su)) {
+        printf("ERROR: corpus puzzle %s/%d did not solve\n", cls->name, i);
+        exit(EXIT_FAILURE);
+      }
+      long long elapsed = now_ns() - start;
+
+      if (rep >= WARMUP && num_samples < MAX_SAMPLES) {
+        samples[num_samples] = elapsed;
+        ++num_samples;
+      }
+    }
+  }
+
+  qsort(samples, num_samples, sizeof(long long), cmp_ll);
+
+  // define and initialize the total of all measured solve times
+  long long total = 0;
+  for (int i = 0; i < num_samples; ++i) {
+    total += samples[i];
+  }
+
+  printf("solve %-12s %8lld ns/op  p50 %8lld  p90 %8lld  max %8lld\n",
+         cls->name, total / num_samples, percentile(samples, num_samples, 50),
+         percentile(samples, num_samples, 90), samples[num_samples - 1]);
+}
+
+// bench_cell_ops(su) benchmarks cell_choices (all 81 cells) and cell_hint on
+//   a representative board and prints ns/op for each.
+// effects: produces output
+//          mutates su
+static void bench_cell_ops(struct sudoku *su) {
+  assert(su);
+
+  assert(sudoku_reset_to(su, MEDIUM[0]));
+
+  // define and initialize the iteration count; the work per iteration is
+  //   tiny, so many iterations are needed for a stable reading
+  const int iters = 20000;
+  // sink accumulates results so the measured calls cannot be optimized away
+  long long sink = 0;
+
+  long long start = now_ns();
+  for (int it = 0; it < iters; ++it) {
+    for (int row = 0; row < 9; ++row) {
+      for (int col = 0; col < 9; ++col) {
+        int choices[9];
+        sink += cell_choices(su, row, col, choices);
+      }
+    }
+  }
+  long long per_board = (now_ns() - start) / iters;
+
+  start = now_ns();
+  for (int it = 0; it < iters; ++it) {
+    int row = 0;
+    int col = 0;
+    sink += cell_hint(su, &row, &col);
+  }
+  long long per_hint = (now_ns() - start) / iters;
+
+  printf("cell_choices (81 cells) %8lld ns/op\n", per_board);
+  printf("cell_hint               %8lld ns/op\n", per_hint);
+  printf("(checksum %lld)\n", sink);
+}
+
+int main(void) {
+  const struct corpus_class classes[] = {
+    { "easy", EASY, sizeof(EASY) / sizeof(EASY[0]) },
+    { "medium", MEDIUM, sizeof(MEDIUM) / sizeof(MEDIUM[0]) },
+    { "hard", HARD, sizeof(HARD) / sizeof(HARD[0]) },
+    { "pathological", PATHOLOGICAL,
+      sizeof(PATHOLOGICAL) / sizeof(PATHOLOGICAL[0]) },
+  };
+
+  struct sudoku *su = malloc(sudoku_size());
+  assert(su);
+
+  for (int c = 0; c < (int)(sizeof(classes) / sizeof(classes[0])); ++c) {
+    bench_solve(&classes[c], su);
+  }
+  bench_cell_ops(su);
+
+  free(su);
+}
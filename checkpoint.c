@@ -0,0 +1,84 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "checkpoint.h"
+
+// === GLOBAL READONLY =====================================================
+
+// CHECKPOINT_MAGIC identifies a checkpoint file (and its format version)
+static const char CHECKPOINT_MAGIC[8] = "sudockp1";
+
+// the on-disk layout: the magic followed by three little-endian 64-bit
+//   counters; fixed-width fields keep the file readable by any build
+struct checkpoint_data {
+  char magic[8];
+  int64_t next_record;
+  int64_t total;
+  int64_t solved;
+};
+
+// see checkpoint.h for documentation
+bool checkpoint_save(const char *path, long next_record, long total,
+                     long solved) {
+  assert(path);
+  assert(next_record >= 0);
+  assert(total >= 0);
+  assert(solved >= 0);
+
+  // define and initialize the temporary name the data is written under
+  //   before the rename makes it visible
+  char tmp_path[1024];
+  if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >=
+      (int)sizeof(tmp_path)) {
+    return false;
+  }
+
+  struct checkpoint_data data;
+  memcpy(data.magic, CHECKPOINT_MAGIC, sizeof(data.magic));
+  data.next_record = next_record;
+  data.total = total;
+  data.solved = solved;
+
+  FILE *out = fopen(tmp_path, "wb");
+  if (!out) {
+    return false;
+  }
+  if (fwrite(&data, sizeof(data), 1, out) != 1) {
+    fclose(out);
+    remove(tmp_path);
+    return false;
+  }
+  fclose(out);
+
+  // the rename is atomic: a reader sees either the old checkpoint or the
+  //   new one, never a torn file
+  return rename(tmp_path, path) == 0;
+}
+
+// see checkpoint.h for documentation
+bool checkpoint_load(const char *path, long *next_record, long *total,
+                     long *solved) {
+  assert(path);
+  assert(next_record);
+  assert(total);
+  assert(solved);
+
+  FILE *in = fopen(path, "rb");
+  if (!in) {
+    return false;
+  }
+
+  struct checkpoint_data data;
+  if (fread(&data, sizeof(data), 1, in) != 1 ||
+      memcmp(data.magic, CHECKPOINT_MAGIC, sizeof(data.magic)) != 0) {
+    fclose(in);
+    return false;
+  }
+  fclose(in);
+
+  *next_record = data.next_record;
+  *total = data.total;
+  *solved = data.solved;
+  return true;
+}
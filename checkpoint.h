@@ -0,0 +1,32 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+
+// A checkpoint records how far a long batch run got through a packed
+//   corpus, so a crash at hour three costs the current puzzle instead of
+//   the whole night. Puzzles are independent, so progress is saved at
+//   puzzle granularity: the next record to solve plus the running
+//   counters. Files are written to a temporary name and renamed into
+//   place, so a checkpoint on disk is always complete.
+
+// checkpoint_save(path, next_record, total, solved) writes a checkpoint to
+//   path via an atomic rename. The function returns true on success, and
+//   false if the file could not be written.
+// requires: path is a valid pointer
+//           next_record, total, and solved are non-negative
+// effects: writes to the file system
+bool checkpoint_save(const char *path, long next_record, long total,
+                     long solved);
+
+// checkpoint_load(path, next_record, total, solved) reads the checkpoint at
+//   path into the pointers. The function returns true on success, and
+//   false if the file is missing or not a checkpoint (the pointers are
+//   left unchanged on failure).
+// requires: path, next_record, total, and solved are valid pointers
+// effects: reads from the file system
+//          might mutate *next_record, *total, and *solved
+bool checkpoint_load(const char *path, long *next_record, long *total,
+                     long *solved);
+
+#endif
@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "corpus.h"
+
+// === GLOBAL READONLY =====================================================
+
+// CORPUS_MAGIC identifies a packed corpus file; it doubles as a version tag
+//   and would change if the record layout ever did
+static const char CORPUS_MAGIC[8] = "sudoku1\n";
+
+struct corpus {
+  // base is the start of the file mapping and len its total size
+  uint8_t *base;
+  size_t len;
+  // count is the number of records behind the header
+  long count;
+};
+
+// see corpus.h for documentation
+struct corpus *corpus_open(const char *path) {
+  assert(path);
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return NULL;
+  }
+
+  // the file must hold the magic plus a whole number of records
+  size_t len = st.st_size;
+  if (len < sizeof(CORPUS_MAGIC) ||
+      (len - sizeof(CORPUS_MAGIC)) % CORPUS_RECORD_LEN != 0) {
+    close(fd);
+    return NULL;
+  }
+
+  uint8_t *base = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file alive, so the descriptor can go either way
+  close(fd);
+  if (base == MAP_FAILED) {
+    return NULL;
+  }
+
+  if (memcmp(base, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) != 0) {
+    munmap(base, len);
+    return NULL;
+  }
+
+  struct corpus *corp = malloc(sizeof(struct corpus));
+  assert(corp);
+  corp->base = base;
+  corp->len = len;
+  corp->count = (len - sizeof(CORPUS_MAGIC)) / CORPUS_RECORD_LEN;
+  return corp;
+}
+
+// see corpus.h for documentation
+long corpus_count(const struct corpus *corp) {
+  assert(corp);
+  return corp->count;
+}
+
+// see corpus.h for documentation
+const uint8_t *corpus_record(const struct corpus *corp, long index) {
+  assert(corp);
+  assert(0 <= index && index < corp->count);
+  return corp->base + sizeof(CORPUS_MAGIC) + index * CORPUS_RECORD_LEN;
+}
+
+// see corpus.h for documentation
+void corpus_close(struct corpus *corp) {
+  assert(corp);
+  munmap(corp->base, corp->len);
+  free(corp);
+}
+
+// corpus_write_magic(out) writes the corpus file header to out. This lives
+//   here (rather than in the converter) so the reader and writer can never
+//   disagree about the magic.
+// requires: out is a valid, writable stream
+// effects: produces output
+void corpus_write_magic(FILE *out) {
+  assert(out);
+  fwrite(CORPUS_MAGIC, 1, sizeof(CORPUS_MAGIC), out);
+}
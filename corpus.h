@@ -0,0 +1,47 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// A corpus is a packed binary puzzle archive mapped into memory: a small
+//   header followed by fixed-size records of 81 cell bytes (values 0 to 9)
+//   in reading order. Opening one costs an mmap, not a parse; records are
+//   handed out as zero-copy pointers into the mapping and only converted to
+//   boards when a record is actually solved.
+struct corpus;
+
+// CORPUS_RECORD_LEN is the size of one puzzle record in bytes
+#define CORPUS_RECORD_LEN 81
+
+// corpus_open(path) maps the corpus file at path into memory and returns a
+//   handle to it, or NULL if the file cannot be opened or is not a valid
+//   corpus.
+// requires: path is a valid pointer
+// effects: might allocate memory (client must call corpus_close)
+struct corpus *corpus_open(const char *path);
+
+// corpus_count(corp) returns the number of puzzle records in corp.
+// requires: corp is a valid pointer
+// time: O(1)
+long corpus_count(const struct corpus *corp);
+
+// corpus_record(corp, index) returns a read-only pointer to the cells of
+//   record index, pointing directly into the mapped file.
+// requires: corp is a valid pointer
+//           index is between 0 and corpus_count(corp) - 1 (both inclusive)
+// time: O(1)
+const uint8_t *corpus_record(const struct corpus *corp, long index);
+
+// corpus_write_magic(out) writes the corpus file header to out; the
+//   converter calls this before appending records.
+// requires: out is a valid, writable stream
+// effects: produces output
+void corpus_write_magic(FILE *out);
+
+// corpus_close(corp) unmaps the corpus file and frees the handle.
+// requires: corp is a valid pointer
+// effects: corp is no longer valid
+void corpus_close(struct corpus *corp);
+
+#endif
@@ -0,0 +1,61 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "corpus.h"
+
+// This is the converter for the packed binary corpus format: it reads
+//   line-delimited 81-character text puzzles ('1' to '9' for givens; '_',
+//   '.', or '0' for empty cells) from stdin and writes fixed-size binary
+//   records to the output file given as the first argument. The batch mode
+//   can then mmap the result with corpus_open and skip text parsing
+//   entirely.
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    printf("usage: %s output-file < puzzles.txt\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  FILE *out = fopen(argv[1], "wb");
+  if (!out) {
+    printf("ERROR: cannot open output file %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  corpus_write_magic(out);
+
+  // define and initialize counters for the conversion report
+  long packed = 0;
+  long skipped = 0;
+
+  // line holds one text puzzle plus the newline and terminator
+  char line[CORPUS_RECORD_LEN + 16];
+  while (fgets(line, sizeof(line), stdin)) {
+    // record holds the decoded cell values of the current puzzle
+    uint8_t record[CORPUS_RECORD_LEN];
+    // ok stays true while every cell character of the line is legal
+    int ok = (strlen(line) >= CORPUS_RECORD_LEN);
+
+    for (int pos = 0; ok && pos < CORPUS_RECORD_LEN; ++pos) {
+      char c = line[pos];
+      if (c == '_' || c == '.' || c == '0') {
+        record[pos] = 0;
+      } else if ('1' <= c && c <= '9') {
+        record[pos] = c - '0';
+      } else {
+        ok = 0;
+      }
+    }
+
+    if (ok) {
+      fwrite(record, 1, CORPUS_RECORD_LEN, out);
+      ++packed;
+    } else {
+      ++skipped;
+    }
+  }
+
+  assert(fclose(out) == 0);
+  printf("Packed %ld puzzles (%ld skipped) into %s\n", packed, skipped,
+         argv[1]);
+}
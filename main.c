@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include "cs136-trace.h"
 #include "array_tools.h"
 #include "sudoku.h"
@@ -25,6 +26,7 @@ static void read_int_n(int *input, int n, char *error_message) {
 
 int main(void) {
   struct sudoku *su = sudoku_read();
+  sudoku_journal_enable(su);
   solution_print(su);
 
   const int CMD_QUIT    = lookup_symbol("quit");
@@ -35,6 +37,11 @@ int main(void) {
   const int CMD_CHOICES = lookup_symbol("choices");
   const int CMD_HINT    = lookup_symbol("hint");
   const int CMD_SOLVE   = lookup_symbol("solve");
+  const int CMD_STATS   = lookup_symbol("stats");
+  const int CMD_GENERATE = lookup_symbol("generate");
+  const int CMD_UNDO    = lookup_symbol("undo");
+  const int CMD_REDO    = lookup_symbol("redo");
+  const int CMD_PROFILE = lookup_symbol("profile");
 
   int cmd = INVALID_SYMBOL;
   while ((cmd = read_symbol()) != INVALID_SYMBOL) {
@@ -43,6 +50,8 @@ int main(void) {
       break;
     } else if (cmd == CMD_RESET) {
       solution_reset(su);
+      // resetting discards the history, so journaling starts fresh
+      sudoku_journal_enable(su);
     } else if (cmd == CMD_PRINT) {
       solution_print(su);
     } else if (cmd == CMD_FILL) {
@@ -81,6 +90,41 @@ int main(void) {
       } else {
         solution_print(su);
       }
+    } else if (cmd == CMD_STATS) {
+      struct sudoku_stats stats;
+      if (!sudoku_solve_stats(su, &stats)) {
+        printf("Could not solve the puzzle using search and backtracking :(\n");
+      } else {
+        solution_print(su);
+      }
+      printf("nodes: %lld\n", stats.nodes);
+      printf("backtracks: %lld\n", stats.backtracks);
+      printf("max depth: %d\n", stats.max_depth);
+      printf("cell_choices calls: %lld\n", stats.choice_calls);
+      printf("propagation passes: %lld\n", stats.propagation_passes);
+      printf("wall time: %lld usec\n", stats.wall_usec);
+    } else if (cmd == CMD_GENERATE) {
+      int input[1] = { 0 }; // input[0] => target clue count
+      read_int_n(input, 1,
+                 "ERROR: cannot read parameters for command generate\n");
+      if (input[0] < 1) {
+        printf("Cannot generate a puzzle with %d clues.\n", input[0]);
+      } else {
+        int clues = sudoku_generate(su, input[0], (unsigned int)time(NULL));
+        sudoku_journal_enable(su);
+        printf("Generated a new puzzle with %d clues.\n", clues);
+        solution_print(su);
+      }
+    } else if (cmd == CMD_UNDO) {
+      if (!sudoku_undo(su)) {
+        printf("Nothing to undo.\n");
+      }
+    } else if (cmd == CMD_REDO) {
+      if (!sudoku_redo(su)) {
+        printf("Nothing to redo.\n");
+      }
+    } else if (cmd == CMD_PROFILE) {
+      sudoku_profile_print();
     } else {
       printf("Invalid Command: ");
       print_symbol(cmd);
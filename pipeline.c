@@ -0,0 +1,243 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "pipeline.h"
+#include "sudoku.h"
+
+// === GLOBAL READONLY =====================================================
+
+// RING_CAP is the number of slots in the ring; it bounds how far the reader
+//   can run ahead of the writer
+#define RING_CAP 256
+// PIPE_MAX_WORKERS is the largest number of solver threads the pipeline uses
+#define PIPE_MAX_WORKERS 32
+
+// a slot moves through three states as a puzzle flows through the pipeline
+enum slot_state {
+  // SLOT_FREE: the writer has drained the slot (or it was never used)
+  SLOT_FREE,
+  // SLOT_READY: the reader has filled the slot with a raw puzzle
+  SLOT_READY,
+  // SLOT_DONE: a worker has solved (or failed to solve) the puzzle
+  SLOT_DONE,
+};
+
+// a slot carries one puzzle through all three stages; its board is
+//   allocated once when the pipeline starts and reused for every puzzle
+//   that passes through the slot
+struct slot {
+  char text[96];
+  struct sudoku *su;
+  bool solved;
+  enum slot_state state;
+};
+
+struct pipeline {
+  struct slot slots[RING_CAP];
+  // seq_read counts puzzles the reader has published, seq_claim the ones
+  //   workers have claimed, and seq_write the ones the writer has drained;
+  //   a sequence number seq lives in slot seq % RING_CAP
+  long seq_read;
+  long seq_claim;
+  long seq_write;
+  // eof is set once the reader has seen the end of the input
+  bool eof;
+  bool compact;
+  // solved counts the puzzles that had a solution
+  int solved;
+  pthread_mutex_t lock;
+  // ready wakes workers (a slot became READY or eof was set), done wakes
+  //   the writer (a slot became DONE), and drained wakes the reader (a slot
+  //   became FREE)
+  pthread_cond_t ready;
+  pthread_cond_t done;
+  pthread_cond_t drained;
+};
+
+// worker_main(arg) is the body of one solver thread: it claims READY slots
+//   in sequence order, solves them, and marks them DONE.
+// effects: mutates the pipeline
+static void *worker_main(void *arg) {
+  assert(arg);
+  struct pipeline *p = arg;
+
+  while (1) {
+    pthread_mutex_lock(&p->lock);
+    while (p->seq_claim == p->seq_read && !p->eof) {
+      pthread_cond_wait(&p->ready, &p->lock);
+    }
+    if (p->seq_claim == p->seq_read && p->eof) {
+      pthread_mutex_unlock(&p->lock);
+      break;
+    }
+
+    // define and initialize the sequence number this worker now owns; the
+    //   slot cannot be touched by anyone else until it is marked DONE
+    long seq = p->seq_claim;
+    ++p->seq_claim;
+    pthread_mutex_unlock(&p->lock);
+
+    struct slot *s = &p->slots[seq % RING_CAP];
+    s->solved = sudoku_reset_to(s->su, s->text) && sudoku_solve(s->su);
+
+    pthread_mutex_lock(&p->lock);
+    s->state = SLOT_DONE;
+    pthread_cond_broadcast(&p->done);
+    pthread_mutex_unlock(&p->lock);
+  }
+
+  return NULL;
+}
+
+// writer_main(arg) is the body of the writer thread: it drains DONE slots
+//   strictly in input order, prints the results, and frees the slots for
+//   the reader to reuse.
+// effects: produces output
+//          mutates the pipeline
+static void *writer_main(void *arg) {
+  assert(arg);
+  struct pipeline *p = arg;
+
+  while (1) {
+    pthread_mutex_lock(&p->lock);
+    struct slot *s = &p->slots[p->seq_write % RING_CAP];
+    while (!(p->seq_write < p->seq_read && s->state == SLOT_DONE) &&
+           !(p->eof && p->seq_write == p->seq_read)) {
+      pthread_cond_wait(&p->done, &p->lock);
+      s = &p->slots[p->seq_write % RING_CAP];
+    }
+    if (p->eof && p->seq_write == p->seq_read) {
+      pthread_mutex_unlock(&p->lock);
+      break;
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    // printing happens outside the lock; this slot is invisible to the
+    //   other stages until its state changes
+    if (s->solved) {
+      if (p->compact) {
+        solution_print_compact(s->su);
+      } else {
+        solution_print(s->su);
+      }
+    } else {
+      printf("Could not solve puzzle %ld using search and backtracking :(\n",
+             p->seq_write + 1);
+    }
+
+    pthread_mutex_lock(&p->lock);
+    if (s->solved) {
+      ++p->solved;
+    }
+    s->state = SLOT_FREE;
+    ++p->seq_write;
+    pthread_cond_broadcast(&p->drained);
+    pthread_mutex_unlock(&p->lock);
+  }
+
+  return NULL;
+}
+
+// read_puzzle(text) reads the next 81 cell characters from stdin into text,
+//   skipping whitespace, and returns true on success and false at the end
+//   of the input.
+// requires: text has space for 82 characters
+// effects: reads from input
+//          might mutate text
+static bool read_puzzle(char *text) {
+  assert(text);
+
+  for (int i = 0; i < 81; ++i) {
+    char c = '\0';
+    if (scanf(" %c", &c) != 1) {
+      assert(i == 0);
+      return false;
+    }
+    text[i] = c;
+  }
+  text[81] = '\0';
+  return true;
+}
+
+// see pipeline.h for documentation
+int pipeline_run(int threads, bool compact, int *total) {
+  assert(threads > 0);
+  assert(total);
+  if (threads > PIPE_MAX_WORKERS) {
+    threads = PIPE_MAX_WORKERS;
+  }
+
+  struct pipeline *p = malloc(sizeof(struct pipeline));
+  assert(p);
+  p->seq_read = 0;
+  p->seq_claim = 0;
+  p->seq_write = 0;
+  p->eof = false;
+  p->compact = compact;
+  p->solved = 0;
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->ready, NULL);
+  pthread_cond_init(&p->done, NULL);
+  pthread_cond_init(&p->drained, NULL);
+  for (int i = 0; i < RING_CAP; ++i) {
+    p->slots[i].su = malloc(sudoku_size());
+    assert(p->slots[i].su);
+    p->slots[i].state = SLOT_FREE;
+  }
+
+  pthread_t workers[PIPE_MAX_WORKERS];
+  for (int i = 0; i < threads; ++i) {
+    assert(pthread_create(&workers[i], NULL, worker_main, p) == 0);
+  }
+  pthread_t writer;
+  assert(pthread_create(&writer, NULL, writer_main, p) == 0);
+
+  // the reader stage runs here on the calling thread
+  while (1) {
+    struct slot *s = NULL;
+
+    pthread_mutex_lock(&p->lock);
+    s = &p->slots[p->seq_read % RING_CAP];
+    while (s->state != SLOT_FREE) {
+      pthread_cond_wait(&p->drained, &p->lock);
+      s = &p->slots[p->seq_read % RING_CAP];
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    // reading happens outside the lock; a FREE slot at seq_read belongs to
+    //   the reader alone
+    if (!read_puzzle(s->text)) {
+      break;
+    }
+
+    pthread_mutex_lock(&p->lock);
+    s->state = SLOT_READY;
+    ++p->seq_read;
+    pthread_cond_broadcast(&p->ready);
+    pthread_mutex_unlock(&p->lock);
+  }
+
+  pthread_mutex_lock(&p->lock);
+  p->eof = true;
+  pthread_cond_broadcast(&p->ready);
+  pthread_cond_broadcast(&p->done);
+  pthread_mutex_unlock(&p->lock);
+
+  for (int i = 0; i < threads; ++i) {
+    pthread_join(workers[i], NULL);
+  }
+  pthread_join(writer, NULL);
+
+  *total = (int)p->seq_read;
+  int solved = p->solved;
+  for (int i = 0; i < RING_CAP; ++i) {
+    free(p->slots[i].su);
+  }
+  pthread_mutex_destroy(&p->lock);
+  pthread_cond_destroy(&p->ready);
+  pthread_cond_destroy(&p->done);
+  pthread_cond_destroy(&p->drained);
+  free(p);
+  return solved;
+}
@@ -0,0 +1,25 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+
+// The pipeline is the batch solving path arranged as three overlapping
+//   stages: the calling thread reads raw puzzles into a ring of
+//   preallocated slots, a pool of worker threads solves them, and a writer
+//   thread drains finished slots in input order. Disk latency on either
+//   end overlaps with solving instead of serializing with it.
+
+// pipeline_run(threads, compact, total) reads line-delimited 81-character
+//   puzzles from stdin until it is exhausted, solves them on the given
+//   number of worker threads, and writes results to stdout in input order
+//   (compact selects the one-line output format). The function stores the
+//   number of puzzles read in total and returns the number that had a
+//   solution.
+// requires: threads must be positive
+//           total is a valid pointer
+// effects: reads from input
+//          produces output
+//          mutates *total
+int pipeline_run(int threads, bool compact, int *total);
+
+#endif
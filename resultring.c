@@ -0,0 +1,98 @@
+#include <assert.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "resultring.h"
+
+// === GLOBAL READONLY =====================================================
+
+// RESULT_RING_CAP is the number of slots; it only has to cover the largest
+//   possible number of in-flight puzzles (the pool bounds those through its
+//   queue capacities), and a power of two keeps the modulo cheap
+#define RESULT_RING_CAP 4096
+
+// a result_slot holds one published result; tag is 0 while the slot is
+//   free and the result's sequence number once it is published, so the tag
+//   store is the only synchronization between producer and consumer
+struct result_slot {
+  struct sudoku *su;
+  bool solved;
+  int id;
+  long record;
+  atomic_long tag;
+};
+
+struct result_ring {
+  struct result_slot slots[RESULT_RING_CAP];
+  // next_seq is the sequence number the consumer takes next; only the
+  //   consumer thread touches it, so it needs no synchronization
+  long next_seq;
+};
+
+// see resultring.h for documentation
+struct result_ring *result_ring_create(void) {
+  struct result_ring *ring = malloc(sizeof(struct result_ring));
+  assert(ring);
+
+  for (int i = 0; i < RESULT_RING_CAP; ++i) {
+    atomic_init(&ring->slots[i].tag, 0);
+  }
+  ring->next_seq = 1;
+  return ring;
+}
+
+// see resultring.h for documentation
+void result_ring_destroy(struct result_ring *ring) {
+  assert(ring);
+  free(ring);
+}
+
+// see resultring.h for documentation
+void result_ring_publish(struct result_ring *ring, long seq,
+                         struct sudoku *su, bool solved, int id,
+                         long record) {
+  assert(ring);
+  assert(seq > 0);
+
+  // sequence numbers are contiguous, so each maps to exactly one slot and
+  //   two producers can never race for the same one
+  struct result_slot *s = &ring->slots[seq % RESULT_RING_CAP];
+
+  // the slot is still occupied only if the consumer is a whole ring behind;
+  //   the acquire pairs with the consumer's release of the drained slot
+  while (atomic_load_explicit(&s->tag, memory_order_acquire) != 0) {
+    sched_yield();
+  }
+
+  s->su = su;
+  s->solved = solved;
+  s->id = id;
+  s->record = record;
+  // the release store is the publication: the consumer's acquire load of
+  //   the tag makes the plain fields above visible with it
+  atomic_store_explicit(&s->tag, seq, memory_order_release);
+}
+
+// see resultring.h for documentation
+bool result_ring_take(struct result_ring *ring, struct sudoku **su,
+                      bool *solved, int *id, long *record) {
+  assert(ring);
+  assert(su);
+  assert(solved);
+  assert(id);
+  assert(record);
+
+  struct result_slot *s = &ring->slots[ring->next_seq % RESULT_RING_CAP];
+  if (atomic_load_explicit(&s->tag, memory_order_acquire) != ring->next_seq) {
+    return false;
+  }
+
+  *su = s->su;
+  *solved = s->solved;
+  *id = s->id;
+  *record = s->record;
+  // the release store frees the slot for the producer a full ring ahead
+  atomic_store_explicit(&s->tag, 0, memory_order_release);
+  ++ring->next_seq;
+  return true;
+}
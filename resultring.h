@@ -0,0 +1,48 @@
+#ifndef RESULTRING_H
+#define RESULTRING_H
+
+#include <stdbool.h>
+#include "sudoku.h"
+
+// A result_ring carries finished puzzles from many solver threads to one
+//   writer thread without any lock: it is a multi-producer single-consumer
+//   ring doubling as a sequence-number reorder buffer. Each result lives in
+//   the slot its sequence number maps to, and a worker publishes it with a
+//   single atomic release store of the sequence tag, so workers finishing
+//   out of order never contend on a shared queue and the consumer still
+//   sees results strictly in input order.
+struct result_ring;
+
+// result_ring_create() returns a new empty ring expecting sequence numbers
+//   that start at 1 and are contiguous.
+// effects: allocates memory (client must call result_ring_destroy)
+struct result_ring *result_ring_create(void);
+
+// result_ring_destroy(ring) frees all memory for ring.
+// requires: every published result has been taken
+// effects: ring is no longer valid
+void result_ring_destroy(struct result_ring *ring);
+
+// result_ring_publish(ring, seq, su, solved, id, record) publishes the
+//   finished puzzle su with sequence number seq; solved records whether it
+//   had a solution, id is its caller-visible number for error messages,
+//   and record is the submitter's position marker for the puzzle (e.g. a
+//   corpus record index), carried through untouched. Safe to call from any
+//   number of threads at once. If the consumer is more than a full ring
+//   behind, the call spins until the slot drains.
+// requires: seq is positive and published exactly once
+// effects: mutates ring
+void result_ring_publish(struct result_ring *ring, long seq,
+                         struct sudoku *su, bool solved, int id, long record);
+
+// result_ring_take(ring, su, solved, id, record) takes the next result in
+//   sequence order if it has been published, storing its fields through
+//   the pointers. The function returns true if a result was taken, and
+//   false if the next-in-order result is not ready yet. Only one thread
+//   may consume from a ring.
+// requires: su, solved, id, and record are valid pointers
+// effects: might mutate ring, *su, *solved, *id, and *record
+bool result_ring_take(struct result_ring *ring, struct sudoku **su,
+                      bool *solved, int *id, long *record);
+
+#endif
@@ -1,6 +1,10 @@
 #include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include "sudoku.h"
 #include "array_tools.h"
 #include "merge_sort.h"
@@ -22,51 +26,594 @@ static const int SUCCESS = 0;
 //   violated
 static const int CONSTRAINT_VIOLATED = -1;
 
+// JOURNAL_CAP is the number of changes the undo/redo journal retains; the
+//   oldest entry is dropped once it fills up
+#define JOURNAL_CAP 256
+
+// a journal_entry describes one reversible change to a cell
+struct journal_entry {
+  uint8_t pos;
+  uint8_t old_val;
+  uint8_t new_val;
+};
+
 struct sudoku {
-  // puzzle contains the start state of the puzzle
-  int puzzle[DIM * DIM];
+  // puzzle contains the start state of the puzzle; cells are single bytes
+  //   (values 0 to 9) so the whole board stays within a couple of cache
+  //   lines instead of spreading over int-sized cells
+  uint8_t puzzle[DIM * DIM];
   // solution contains is equal to puzzle at the beginning and then stores
   //   all numbers filled in by the player.
-  int solution[DIM * DIM];
+  uint8_t solution[DIM * DIM];
+  // row_used[r] holds one bit per number (bit num is set if num appears in
+  //   row r of solution), so a constraint check is a single bit test instead
+  //   of a scan over nine cells.
+  uint16_t row_used[DIM];
+  // col_used[c] holds one bit per number that appears in column c
+  uint16_t col_used[DIM];
+  // box_used[b] holds one bit per number that appears in box b, where boxes
+  //   are numbered 0 to 8 in reading order
+  uint16_t box_used[DIM];
+  // journal_on records whether fills and erases are being journaled; the
+  //   solver always runs with it off so searches never pollute the history
+  bool journal_on;
+  // the journal holds the last JOURNAL_CAP changes; entries [0, journal_len)
+  //   are valid and journal_cur of them are currently applied, so undo steps
+  //   the cursor left and redo steps it right
+  int journal_len;
+  int journal_cur;
+  // journal_dropped counts entries the full journal has discarded since
+  //   the board was loaded, so snapshot tokens (absolute change numbers)
+  //   can detect that their history is gone
+  long journal_dropped;
+  struct journal_entry journal[JOURNAL_CAP];
+  // cand_valid records whether the hint cache below describes the board; the
+  //   solver drops the whole cache on entry instead of paying per-fill
+  //   maintenance for millions of search moves
+  bool cand_valid;
+  // cand[pos] is the cached candidate mask of empty cell pos (bit num is set
+  //   if num can legally go there); filled cells hold 0
+  uint16_t cand[DIM * DIM];
+  // cand_count[pos] is the bucket currently holding pos (its number of
+  //   candidates), or -1 when pos is filled and not queued
+  int8_t cand_count[DIM * DIM];
+  // bucket_head[c], bucket_next[pos], and bucket_prev[pos] form one doubly
+  //   linked list of empty cells per candidate count, so the next cell with
+  //   a single candidate is always bucket_head[1]
+  int8_t bucket_head[DIM + 1];
+  int8_t bucket_next[DIM * DIM];
+  int8_t bucket_prev[DIM * DIM];
+  // hash is the Zobrist hash of su->solution, kept in step incrementally
+  //   (one xor per placed or removed number) so the transposition cache
+  //   never has to hash a whole board
+  uint64_t hash;
+};
+
+// === LOOKUP TABLES ========================================================
+
+// NUM_PEERS is the number of peers of a cell: the other cells of its row,
+//   column, and box (8 + 8 + 4, with the box overlaps removed)
+#define NUM_PEERS 20
+
+// CELL_BOX[pos] is the box (0 to 8, in reading order) containing cell pos,
+//   so the hot paths never divide to find it
+static uint8_t CELL_BOX[DIM * DIM];
+// GROUP_MEMBERS[g][k] is the position of the k-th member of group g, where
+//   groups 0 to 8 are the rows, 9 to 17 the columns, and 18 to 26 the boxes
+static uint8_t GROUP_MEMBERS[3 * DIM][DIM];
+// CELL_PEERS[pos] lists the 20 cells sharing a row, column, or box with pos
+static uint8_t CELL_PEERS[DIM * DIM][NUM_PEERS];
+// ZOBRIST[pos][num] is the random bit pattern xored into a board's hash
+//   when cell pos holds num; ZOBRIST[pos][0] is zero, so empty cells never
+//   contribute and clearing a cell needs no extra xor
+static uint64_t ZOBRIST[DIM * DIM][DIM + 1];
+// tables_once gates the one-time construction of the tables above
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// tables_build() fills in the lookup tables; it runs exactly once, under
+//   tables_once.
+// effects: mutates the lookup tables
+static void tables_build(void) {
+  for (int row = 0; row < DIM; ++row) {
+    for (int col = 0; col < DIM; ++col) {
+      CELL_BOX[row * DIM + col] = (row / DIMBOX) * DIMBOX + col / DIMBOX;
+    }
+  }
+
+  for (int g = 0; g < DIM; ++g) {
+    for (int k = 0; k < DIM; ++k) {
+      // group g as a row, g + DIM as a column, and g + 2 * DIM as a box
+      GROUP_MEMBERS[g][k] = g * DIM + k;
+      GROUP_MEMBERS[g + DIM][k] = k * DIM + g;
+      GROUP_MEMBERS[g + 2 * DIM][k] =
+          ((g / DIMBOX) * DIMBOX + k / DIMBOX) * DIM +
+          (g % DIMBOX) * DIMBOX + k % DIMBOX;
+    }
+  }
+
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    // define and initialize the row and col of the current cell and a count
+    //   of the peers recorded so far
+    int row = pos / DIM;
+    int col = pos % DIM;
+    int n = 0;
+
+    for (int other = 0; other < DIM * DIM; ++other) {
+      if (other != pos &&
+          (other / DIM == row || other % DIM == col ||
+           CELL_BOX[other] == CELL_BOX[pos])) {
+        CELL_PEERS[pos][n] = other;
+        ++n;
+      }
+    }
+    assert(n == NUM_PEERS);
+  }
+
+  // define and initialize a fixed-seed xorshift state, so the hash of a
+  //   given board is the same in every process
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    ZOBRIST[pos][0] = 0;
+    for (int num = 1; num <= DIM; ++num) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      ZOBRIST[pos][num] = state;
+    }
+  }
+}
+
+// tables_ensure() fills in the lookup tables on the first call and does
+//   nothing afterwards. It runs whenever a board is (re)loaded, and boards
+//   are loaded concurrently (every generator thread of batch --generate
+//   calls this on startup), so the once guard is what makes the filled
+//   tables visible to all threads before any of them reads one.
+// effects: might mutate the lookup tables
+static void tables_ensure(void) {
+  pthread_once(&tables_once, tables_build);
+}
+
+// === TRANSPOSITION CACHE ==================================================
+
+// cache_slots is the open-addressed verdict table, or NULL while no one has
+//   called sudoku_cache_init; a slot holds the hash of a board state proven
+//   unsolvable (only unsolvable verdicts are stored: a solvable verdict
+//   carries no solution, so it could never end a search early). Pool
+//   workers read and write slots concurrently, so each slot is a relaxed
+//   atomic: losing a racing overwrite is fine (the cache is lossy anyway),
+//   but every value read is one some thread actually wrote, never a torn
+//   mix that could alias a real board.
+static _Atomic uint64_t *cache_slots = NULL;
+// cache_index_mask is the slot count minus one (the count is a power of two)
+static uint64_t cache_index_mask = 0;
+
+// cache_unsolvable(hash) returns true if the board state with this hash has
+//   been recorded as unsolvable.
+// time: O(1)
+static bool cache_unsolvable(const uint64_t hash) {
+  return cache_slots &&
+         atomic_load_explicit(&cache_slots[hash & cache_index_mask],
+                              memory_order_relaxed) == hash;
+}
+
+// cache_record(hash) records the board state with this hash as unsolvable,
+//   evicting whatever the slot held before.
+// effects: might mutate the cache
+// time: O(1)
+static void cache_record(const uint64_t hash) {
+  if (cache_slots) {
+    atomic_store_explicit(&cache_slots[hash & cache_index_mask], hash,
+                          memory_order_relaxed);
+  }
+}
+
+// === SOLVER INSTRUMENTATION ===============================================
+
+// active_stats points at the counters of the solve currently running under
+//   sudoku_solve_stats, or is NULL when no one asked for instrumentation; it
+//   is per-thread so instrumented solves do not interfere with the pool
+#ifndef SUDOKU_NOSTATS
+static _Thread_local struct sudoku_stats *active_stats = NULL;
+
+// STATS_BUMP(field) adds one to a counter when instrumentation is active;
+//   with SUDOKU_NOSTATS defined it compiles away to nothing
+#define STATS_BUMP(field) \
+  do { if (active_stats) { ++active_stats->field; } } while (0)
+
+// STATS_DEPTH(d) records d as the deepest search level reached so far
+#define STATS_DEPTH(d) \
+  do { \
+    if (active_stats && (d) > active_stats->max_depth) { \
+      active_stats->max_depth = (d); \
+    } \
+  } while (0)
+#else
+#define STATS_BUMP(field) do { } while (0)
+#define STATS_DEPTH(d) do { } while (0)
+#endif
+
+// === HOT-PATH PROFILING ===================================================
+
+// Building with -DSUDOKU_PROFILE compiles in per-site call and cycle
+//   counters around the solver's hot helpers, so a latency regression can
+//   be diagnosed on the workload that triggered it instead of rebuilding
+//   under an external profiler. Without the flag every hook expands to
+//   nothing and the object code is identical to an uninstrumented build.
+
+#ifdef SUDOKU_PROFILE
+// the instrumented sites, in the order they are printed
+enum {
+  PROF_VIOLATE_ROW,
+  PROF_VIOLATE_COL,
+  PROF_VIOLATE_BOX,
+  PROF_CELL_CHOICES,
+  PROF_LEAST_POSSIBLE,
+  PROF_SOLVE,
+  PROF_NUM_SITES,
+};
+
+// PROF_NAMES holds the printable name of each site
+static const char *const PROF_NAMES[PROF_NUM_SITES] = {
+  "violate_row", "violate_col", "violate_box",
+  "cell_choices", "least_possible_solutions", "sudoku_solve",
 };
 
+// prof_site accumulates the calls and elapsed ticks of one site
+struct prof_site {
+  long long calls;
+  long long ticks;
+};
+
+// the counters are per-thread (like active_stats above), so pool workers
+//   never contend on them; a dump reports the calling thread's totals
+static _Thread_local struct prof_site prof_sites[PROF_NUM_SITES];
+
+// prof_ticks() returns a monotonic tick count: raw cycles where the
+//   hardware counter is reachable, nanoseconds otherwise.
+// time: O(1)
+static unsigned long long prof_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int lo = 0;
+  unsigned int hi = 0;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((unsigned long long)hi << 32) | lo;
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (unsigned long long)t.tv_sec * 1000000000ULL +
+         (unsigned long long)t.tv_nsec;
+#endif
+}
+
+// PROF_COUNT(site) adds one call to a site without timing it; used for the
+//   single-bit-test helpers, where reading the clock costs more than the
+//   helper itself (their cost shows up inside the timed callers)
+#define PROF_COUNT(site) do { ++prof_sites[site].calls; } while (0)
+
+// PROF_DECL(var) captures the tick count at the top of a timed site
+#define PROF_DECL(var) unsigned long long var = prof_ticks()
+
+// PROF_TIME(site, var) charges the ticks since PROF_DECL(var) to a site
+#define PROF_TIME(site, var) \
+  do { \
+    prof_sites[site].ticks += (long long)(prof_ticks() - (var)); \
+    ++prof_sites[site].calls; \
+  } while (0)
+#else
+#define PROF_COUNT(site) do { } while (0)
+#define PROF_DECL(var) do { } while (0)
+#define PROF_TIME(site, var) do { } while (0)
+#endif
+
 // === HELPER FUNCTIONS =====================================================
 
-// violate_row(su, row, num) returns CONSTRAINT_VIOLATED if num will violate 
+// box_index(row, col) returns the index (0 to 8, in reading order) of the box
+//   that contains the cell (row,col).
+// requires: row is an integer between 0 and 8 (both inclusive)
+//           col is an integer between 0 and 8 (both inclusive)
+//           the lookup tables have been filled in
+// time: O(1)
+static int box_index(const int row, const int col) {
+  assert(0 <= row && row <= 8);
+  assert(0 <= col && col <= 8);
+  return CELL_BOX[row * DIM + col];
+}
+
+// masks_place(su, row, col, num) records num as occupied in the row-, column-,
+//   and box-masks for the cell (row,col).
+// requires: row is an integer between 0 and 8 (both inclusive)
+//           col is an integer between 0 and 8 (both inclusive)
+//           num is an integer between 1 and 9
+// effects: mutates su
+// time: O(1)
+static void masks_place(struct sudoku *su, const int row, const int col,
+                        const int num) {
+  assert(su);
+  assert(1 <= num && num <= 9);
+  su->row_used[row] |= (uint16_t)(1 << num);
+  su->col_used[col] |= (uint16_t)(1 << num);
+  su->box_used[box_index(row, col)] |= (uint16_t)(1 << num);
+  su->hash ^= ZOBRIST[row * DIM + col][num];
+}
+
+// masks_remove(su, row, col, num) clears num from the row-, column-, and
+//   box-masks for the cell (row,col).
+// requires: row is an integer between 0 and 8 (both inclusive)
+//           col is an integer between 0 and 8 (both inclusive)
+//           num is an integer between 1 and 9
+// effects: mutates su
+// time: O(1)
+static void masks_remove(struct sudoku *su, const int row, const int col,
+                         const int num) {
+  assert(su);
+  assert(1 <= num && num <= 9);
+  su->row_used[row] &= (uint16_t)~(1 << num);
+  su->col_used[col] &= (uint16_t)~(1 << num);
+  su->box_used[box_index(row, col)] &= (uint16_t)~(1 << num);
+  su->hash ^= ZOBRIST[row * DIM + col][num];
+}
+
+// masks_rebuild(su) recomputes all row-, column-, and box-masks from the
+//   current contents of su->solution.
+// effects: mutates su
+// time: O(n) where n is the length of su->solution
+static void masks_rebuild(struct sudoku *su) {
+  assert(su);
+
+  // every board passes through here when it is loaded or reset, which makes
+  //   it the one place that has to guarantee the lookup tables exist
+  tables_ensure();
+
+  for (int i = 0; i < DIM; ++i) {
+    su->row_used[i] = 0;
+    su->col_used[i] = 0;
+    su->box_used[i] = 0;
+  }
+  su->hash = 0;
+
+  for (int row = 0; row < DIM; ++row) {
+    for (int col = 0; col < DIM; ++col) {
+      // define and initialize the number stored in the current cell
+      int num = su->solution[row * DIM + col];
+
+      if (num != EMPTY) {
+        masks_place(su, row, col, num);
+      }
+    }
+  }
+
+  // a rebuild means the board's contents were replaced wholesale, so any
+  //   recorded history no longer describes the board; this also doubles as
+  //   the journal's initialization on a freshly allocated board
+  su->journal_on = false;
+  su->journal_len = 0;
+  su->journal_cur = 0;
+  su->journal_dropped = 0;
+
+  // the hint cache described the old contents; it is rebuilt lazily the
+  //   next time a hint is asked for
+  su->cand_valid = false;
+}
+
+// cand_mask(su, pos) returns the candidate mask of cell pos: one bit per
+//   number that none of its three groups already contains.
+// requires: pos is a valid position
+//           the lookup tables have been filled in
+// time: O(1)
+static uint16_t cand_mask(const struct sudoku *su, const int pos) {
+  assert(su);
+
+  // define and initialize the combined mask of all numbers already used in
+  //   the row, column, and box of the cell
+  uint16_t used = su->row_used[pos / DIM] | su->col_used[pos % DIM] |
+                  su->box_used[CELL_BOX[pos]];
+
+  // 0x3fe keeps bits 1 to 9 (the legal numbers) of the complement
+  return (uint16_t)(~used & 0x3fe);
+}
+
+// mask_count(mask) returns the number of bits set in mask.
+// time: O(1)
+static int mask_count(const uint16_t mask) {
+  // define and initialize a number to record the bits counted so far
+  int n = 0;
+
+  for (int num = 1; num <= DIM; ++num) {
+    if (mask & (1 << num)) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+// bucket_remove(su, pos) unlinks pos from its candidate-count bucket, if it
+//   is in one.
+// requires: pos is a valid position
+// effects: might mutate su
+// time: O(1)
+static void bucket_remove(struct sudoku *su, const int pos) {
+  assert(su);
+
+  // define and initialize the bucket currently holding pos
+  int c = su->cand_count[pos];
+  if (c < 0) {
+    return;
+  }
+
+  if (su->bucket_prev[pos] >= 0) {
+    su->bucket_next[su->bucket_prev[pos]] = su->bucket_next[pos];
+  } else {
+    su->bucket_head[c] = su->bucket_next[pos];
+  }
+  if (su->bucket_next[pos] >= 0) {
+    su->bucket_prev[su->bucket_next[pos]] = su->bucket_prev[pos];
+  }
+  su->cand_count[pos] = -1;
+}
+
+// bucket_insert(su, pos, count) links pos at the front of the bucket of
+//   cells with count candidates.
+// requires: pos is a valid position
+//           count is between 0 and 9
+// effects: mutates su
+// time: O(1)
+static void bucket_insert(struct sudoku *su, const int pos, const int count) {
+  assert(su);
+  assert(0 <= count && count <= DIM);
+
+  su->cand_count[pos] = count;
+  su->bucket_prev[pos] = -1;
+  su->bucket_next[pos] = su->bucket_head[count];
+  if (su->bucket_head[count] >= 0) {
+    su->bucket_prev[su->bucket_head[count]] = pos;
+  }
+  su->bucket_head[count] = pos;
+}
+
+// cand_refresh(su, pos) recomputes the cached candidate set of cell pos and
+//   files the cell in the right bucket; filled cells leave the queue.
+// requires: pos is a valid position
+// effects: mutates su
+// time: O(1)
+static void cand_refresh(struct sudoku *su, const int pos) {
+  assert(su);
+
+  bucket_remove(su, pos);
+  if (su->solution[pos] == EMPTY) {
+    su->cand[pos] = cand_mask(su, pos);
+    bucket_insert(su, pos, mask_count(su->cand[pos]));
+  } else {
+    su->cand[pos] = 0;
+  }
+}
+
+// hint_cache_rebuild(su) recomputes the whole hint cache from the board.
+// effects: mutates su
+// time: O(n) where n is the length of su->solution
+static void hint_cache_rebuild(struct sudoku *su) {
+  assert(su);
+
+  for (int c = 0; c <= DIM; ++c) {
+    su->bucket_head[c] = -1;
+  }
+  // walk backwards so the head of each bucket is the lowest position, which
+  //   keeps hints in reading order right after a rebuild
+  for (int pos = DIM * DIM - 1; pos >= 0; --pos) {
+    su->cand_count[pos] = -1;
+    cand_refresh(su, pos);
+  }
+  su->cand_valid = true;
+}
+
+// hint_cache_update(su, pos) refreshes the cached candidates of pos and its
+//   20 peers after the cell changed; a no-op while the cache is invalid, so
+//   it costs one flag test on un-hinted boards.
+// requires: pos is a valid position
+// effects: might mutate su
+// time: O(1)
+static void hint_cache_update(struct sudoku *su, const int pos) {
+  assert(su);
+
+  if (!su->cand_valid) {
+    return;
+  }
+  cand_refresh(su, pos);
+  for (int k = 0; k < NUM_PEERS; ++k) {
+    cand_refresh(su, CELL_PEERS[pos][k]);
+  }
+}
+
+// journal_record(su, pos, old_val, new_val) appends one change to the
+//   journal if journaling is on, discarding any undone entries ahead of the
+//   cursor and the oldest entry if the journal is full.
+// requires: pos is a valid position
+// effects: might mutate su
+// time: O(1) amortized
+static void journal_record(struct sudoku *su, int pos, int old_val,
+                           int new_val) {
+  assert(su);
+
+  if (!su->journal_on) {
+    return;
+  }
+
+  // a new change invalidates everything that had been undone
+  su->journal_len = su->journal_cur;
+
+  if (su->journal_len == JOURNAL_CAP) {
+    // drop the oldest entry; shifting is O(JOURNAL_CAP) but only happens
+    //   once the journal is full
+    for (int i = 1; i < JOURNAL_CAP; ++i) {
+      su->journal[i - 1] = su->journal[i];
+    }
+    --su->journal_len;
+    --su->journal_cur;
+    ++su->journal_dropped;
+  }
+
+  su->journal[su->journal_len].pos = pos;
+  su->journal[su->journal_len].old_val = old_val;
+  su->journal[su->journal_len].new_val = new_val;
+  ++su->journal_len;
+  su->journal_cur = su->journal_len;
+}
+
+// set_cell_raw(su, pos, val) sets the cell at pos to val, keeping the
+//   occupancy masks in step, without consulting constraints or the journal;
+//   undo and redo use it to replay recorded changes.
+// requires: pos is a valid position
+//           val is an integer between 0 and 9
+// effects: mutates su
+// time: O(1)
+static void set_cell_raw(struct sudoku *su, int pos, int val) {
+  assert(su);
+
+  // define and initialize the value currently stored in the cell
+  int old_val = su->solution[pos];
+
+  if (old_val != EMPTY) {
+    masks_remove(su, pos / DIM, pos % DIM, old_val);
+  }
+  if (val != EMPTY) {
+    masks_place(su, pos / DIM, pos % DIM, val);
+  }
+  su->solution[pos] = val;
+  hint_cache_update(su, pos);
+}
+
+// violate_row(su, row, num) returns CONSTRAINT_VIOLATED if num will violate
 //   the related row in su, and SUCCESS otherwise.
 // requires: row is an integer between 0 and 8 (both inclusive)
 // time: O(1)
-// the function will run at most 9 iterations in the worsest case
+// the function is a single bit test against the row mask
 static int violate_row(const struct sudoku *su, const int row, const int num) {
   assert(su);
   assert(0 <= row && row <= 8);
 
-  // we check each element in row of su->solution to find whether there is a
-  //   number that equals num
-  for (int i = 0; i < DIM; ++i) {
-    if (su->solution[row * DIM + i] == num) {
-      return CONSTRAINT_VIOLATED;
-    }
+  PROF_COUNT(PROF_VIOLATE_ROW);
+
+  // we test the bit for num in the row mask instead of scanning the row
+  if (su->row_used[row] & (1 << num)) {
+    return CONSTRAINT_VIOLATED;
   }
 
   return SUCCESS;
 }
 
-// violate_col(su, col, num) returns CONSTRAINT_VIOLATED if num will violate 
+// violate_col(su, col, num) returns CONSTRAINT_VIOLATED if num will violate
 //   the related column in su, and SUCCESS otherwise.
 // requires: col is an integer between 0 and 8 (both inclusive)
 // time: O(1)
-// the function will run at most 9 iterations in the worsest case
+// the function is a single bit test against the column mask
 static int violate_col(const struct sudoku *su, const int col, const int num) {
   assert(su);
   assert(0 <= col && col <= 8);
 
-  // we check each element in col of su->solution to find whether there is a
-  //   number that equals num
-  for (int i = 0; i < DIM; ++i) {
-    if (su->solution[i * DIM + col] == num) {
-      return CONSTRAINT_VIOLATED;
-    }
+  PROF_COUNT(PROF_VIOLATE_COL);
+
+  // we test the bit for num in the column mask instead of scanning the column
+  if (su->col_used[col] & (1 << num)) {
+    return CONSTRAINT_VIOLATED;
   }
 
   return SUCCESS;
@@ -77,47 +624,38 @@ static int violate_col(const struct sudoku *su, const int col, const int num) {
 // requires: row is an integer between 0 and 8 (both inclusive)
 //           col is an integer between 0 and 8 (both inclusive)
 // time: O(1)
-// the function will run at most 9 iterations in the worsest case
-static int violate_box(const struct sudoku *su, const int row, const int col, 
+// the function is a single bit test against the box mask
+static int violate_box(const struct sudoku *su, const int row, const int col,
                        const int num) {
   assert(su);
   assert(0 <= row && row <= 8);
   assert(0 <= col && col <= 8);
 
-  // define and initialize a number to record the row and col number of the box
-  int row_box = row / DIMBOX;
-  int col_box = col / DIMBOX;
+  PROF_COUNT(PROF_VIOLATE_BOX);
 
-  // define and initialize the position of the left top number in box
-  int row_pos = row_box * DIMBOX;
-  int col_pos = col_box * DIMBOX;
-
-  // we check each element in related box of su->solution to find whether 
-  //   there is a number that equals num
-  for (int i = row_pos; i < (row_box + 1) * DIMBOX; ++i) {
-    for (int j = col_pos; j < (col_box + 1) * DIMBOX; ++j) {
-      if (su->solution[i * DIM + j] == num) {
-        return CONSTRAINT_VIOLATED;
-      }
-    }
+  // we test the bit for num in the box mask instead of scanning the box
+  if (su->box_used[box_index(row, col)] & (1 << num)) {
+    return CONSTRAINT_VIOLATED;
   }
 
   return SUCCESS;
 }
 
-// least_possible_solutions(su, row, col, choices) determines all the possible 
-//   values for each elements that do not violate any of the row-, column-, and
-//   box- constraints. The function writes all possible values for the element
-//   having the least possible solutions into choices, and modifies the row 
-//   and col to be row and col of the element, and returns the number of 
-//   choices or 0 if there is no such number.
+// least_possible_scan(su, row, col, choices) finds the empty cell with
+//   the fewest possible values that do not violate any of the row-, column-,
+//   and box- constraints. The function writes the possible values for that
+//   cell into choices, modifies row and col to be its indices, and returns
+//   the number of choices. The function returns 0 if some empty cell has no
+//   possible value (the board cannot be completed) or if there is no empty
+//   cell.
 // effects: might modify row and col
 //          modify choices
 // time: O(n)
-// the function will check each elemetns with O(1) time two times which is
-//   O(2*n) = O(n)
-static int least_possible_solutions(struct sudoku *su, int *row, int *col, 
-                                    int choices[]) {
+// the function checks each element exactly once, and stops early as soon as
+//   it sees a cell with zero or one possible value, since no later cell can
+//   do better
+static int least_possible_scan(struct sudoku *su, int *row, int *col,
+                               int choices[]) {
   assert(su);
   assert(row);
   assert(col);
@@ -126,104 +664,440 @@ static int least_possible_solutions(struct sudoku *su, int *row, int *col,
   // define and initialize a number to record the least possible solutions
   int least = DIM + 1;
 
-  // check each element of su->solution and finds and compare the number of
-  //   possible solution for each empty element
+  // check each element of su->solution once, keeping the best cell and its
+  //   choices as we go
   for (int i = 0; i < DIM; ++i) {
     for (int j = 0; j < DIM; ++j) {
       if (su->solution[i * DIM + j] == EMPTY) {
+        // define and initialize an array to hold this cell's choices, so the
+        //   best choices found so far are not overwritten
+        int cell[DIM];
+
         // define and initialize a number to record number of choices, and
-        //   modifies choices to record the possible solution
-        int num_choices = cell_choices(su, i, j, choices);
+        //   modifies cell to record the possible solution
+        int num_choices = cell_choices(su, i, j, cell);
 
-        if (num_choices > 0 && num_choices < least) {
+        if (num_choices == 0) {
+          // a dead branch: this cell can never be filled, so the caller
+          //   should not bother trying any of the other cells
+          return 0;
+        }
+
+        if (num_choices < least) {
           least = num_choices;
+          *row = i;
+          *col = j;
+          for (int k = 0; k < num_choices; ++k) {
+            choices[k] = cell[k];
+          }
+
+          if (least == 1) {
+            // a forced cell: no other cell can have fewer choices
+            return 1;
+          }
         }
       }
     }
   }
 
-  // check each element of su to find the positivn that can have the least
-  //   number of possible solutions
-  for (int i = 0; i < DIM; ++i) {
-    for (int j = 0; j < DIM; ++j) {
-      if (su->solution[i * DIM + j] == EMPTY) {
+  if (least == DIM + 1) {
+    return 0;
+  }
+  return least;
+}
+
+// least_possible_solutions(su, row, col, choices) is the instrumented entry
+//   to least_possible_scan above; the scan has several early returns, so
+//   timing it from a single-exit wrapper keeps the hooks out of its body.
+//   Without SUDOKU_PROFILE the wrapper is a plain tail call and vanishes.
+// effects: might modify row and col
+//          modify choices
+// time: O(n)
+static int least_possible_solutions(struct sudoku *su, int *row, int *col,
+                                    int choices[]) {
+  PROF_DECL(prof_t0);
+  int least = least_possible_scan(su, row, col, choices);
+  PROF_TIME(PROF_LEAST_POSSIBLE, prof_t0);
+  return least;
+}
+
+// group_member(g, k) returns the position (index into a board array) of the
+//   k-th member of group g, where groups 0 to 8 are the rows, 9 to 17 are
+//   the columns, and 18 to 26 are the boxes in reading order.
+// requires: g is an integer between 0 and 26 (both inclusive)
+//           k is an integer between 0 and 8 (both inclusive)
+//           the lookup tables have been filled in
+// time: O(1)
+static int group_member(const int g, const int k) {
+  assert(0 <= g && g <= 3 * DIM - 1);
+  assert(0 <= k && k <= DIM - 1);
+  return GROUP_MEMBERS[g][k];
+}
+
+// cell_allows(su, row, col, num) returns true if putting num at (row,col)
+//   would not violate any of the row-, column-, or box-constraints, and
+//   false otherwise.
+// requires: row and col are valid indices
+//           num is an integer between 1 and 9
+// time: O(1)
+static bool cell_allows(const struct sudoku *su, const int row, const int col,
+                        const int num) {
+  assert(su);
+  return !violate_row(su, row, num) && !violate_col(su, col, num) &&
+         !violate_box(su, row, col, num);
+}
+
+// propagate_singles(su, filled, num_filled) repeatedly fills every cell whose
+//   value is forced -- naked singles (an empty cell with exactly one possible
+//   value) and hidden singles (a number with exactly one possible cell left
+//   within a row, column, or box) -- until no forced cell remains. The
+//   position of every cell filled is appended to filled and counted in
+//   num_filled, so the caller can erase them again if a guess above turns
+//   out to be wrong. The function returns false if it runs into a
+//   contradiction (an empty cell, or a missing number in a group, with no
+//   possible placement), and true otherwise.
+// requires: filled is a valid array with length DIM * DIM
+//           num_filled is a valid pointer
+// effects: might mutate su, filled, and num_filled
+// time: O(n^2)
+// each pass over the board is O(n), and every pass except the last fills at
+//   least one cell, so there are at most n passes
+static bool propagate_singles(struct sudoku *su, int filled[],
+                              int *num_filled) {
+  assert(su);
+  assert(filled);
+  assert(num_filled);
+
+  // define and initialize a flag recording whether the last pass filled a
+  //   cell; another pass is only worthwhile if it did
+  bool progress = true;
+
+  while (progress) {
+    progress = false;
+    STATS_BUMP(propagation_passes);
+
+    // first phase: naked singles
+    for (int pos = 0; pos < DIM * DIM; ++pos) {
+      if (su->solution[pos] == EMPTY) {
+        // define and initialize a array to record the possible choices
+        int choices[DIM];
+
         // define and initialize a number to record number of choices, and
         //   modifies choices to record the possible solution
-        int num_choices = cell_choices(su, i, j, choices);
+        int num_choices = cell_choices(su, pos / DIM, pos % DIM, choices);
 
-        if (num_choices == least) {
-          *row = i;
-          *col = j;
-          return num_choices;
+        if (num_choices == 0) {
+          return false;
+        }
+        if (num_choices == 1) {
+          assert(cell_fill(su, pos / DIM, pos % DIM, choices[0]));
+          filled[*num_filled] = pos;
+          ++*num_filled;
+          progress = true;
+        }
+      }
+    }
+
+    // second phase: hidden singles, checked for every group and number
+    for (int g = 0; g < 3 * DIM; ++g) {
+      for (int num = 1; num <= 9; ++num) {
+        // define and initialize a count of the empty cells in the group that
+        //   could hold num, and the position of the last such cell
+        int count = 0;
+        int only_pos = -1;
+        // define and initialize a flag recording whether num is already
+        //   placed somewhere in the group
+        bool placed = false;
+
+        for (int k = 0; k < DIM; ++k) {
+          // define and initialize the position of the k-th member of group g
+          int pos = group_member(g, k);
+
+          if (su->solution[pos] == num) {
+            placed = true;
+            break;
+          }
+          if (su->solution[pos] == EMPTY &&
+              cell_allows(su, pos / DIM, pos % DIM, num)) {
+            ++count;
+            only_pos = pos;
+          }
+        }
+
+        if (placed) {
+          continue;
+        }
+        if (count == 0) {
+          // num is missing from the group but has nowhere left to go
+          return false;
+        }
+        if (count == 1) {
+          assert(cell_fill(su, only_pos / DIM, only_pos % DIM, num));
+          filled[*num_filled] = only_pos;
+          ++*num_filled;
+          progress = true;
         }
       }
     }
   }
 
-  return 0;
+  return true;
 }
 
 // === CORE FUNCTIONS =====================================================
 
 // see sudoku.h for documentation
-struct sudoku *sudoku_read(void) {
-  struct sudoku *su = malloc(sizeof(struct sudoku));
+bool sudoku_read_into(struct sudoku *su) {
   assert(su);
-  int *pPuz = su->puzzle, *pSol = su->solution;
+  uint8_t *pPuz = su->puzzle, *pSol = su->solution;
   for (int cnt = 0; cnt < DIM * DIM; ++cnt, ++pPuz, ++pSol) {
     char c = '\0';
-    assert(scanf(" %c", &c) == 1);
+    if (scanf(" %c", &c) != 1) {
+      // reaching the end of input before the first cell simply means there
+      //   are no more puzzles; anything later is a truncated puzzle
+      assert(cnt == 0);
+      return false;
+    }
     *pPuz = *pSol = (c == PRINT[EMPTY]) ? 0 : c - '0';
   }
-  return su;
+  masks_rebuild(su);
+  return true;
 }
 
 // see sudoku.h for documentation
-void sudoku_destroy(struct sudoku *su) {
+struct sudoku *sudoku_read(void) {
+  struct sudoku *su = malloc(sizeof(struct sudoku));
   assert(su);
-  free(su);
+  assert(sudoku_read_into(su));
+  return su;
 }
 
-// solution_print_separator() prints out a separator between boxes.
-// produces output
-static void solution_print_separator(void) {
-  for (int box = 0; box < DIM / DIMBOX; ++box) {
-    printf("+");
-    for (int i = 0; i < 3 * DIMBOX; ++i) {
-      printf("-");
-    }
-  }
-  printf("+\n");
-}
+// cells_valid(cells) returns true if the given board array (DIM * DIM cell
+//   values) violates none of the row-, column-, or box-constraints and
+//   every value is between EMPTY and 9, and false otherwise.
+// requires: cells is a valid array with length DIM * DIM
+// time: O(n)
+// the function makes a single pass, marking each value in fresh per-row,
+//   per-column, and per-box bitmasks and failing as soon as a bit repeats
+static bool cells_valid(const uint8_t cells[]) {
+  assert(cells);
 
-// see sudoku.h for documentation
-void solution_print(const struct sudoku *su) {
-  assert(su);
+  // validation runs before a board is loaded, so the tables box_index needs
+  //   may not exist yet
+  tables_ensure();
 
-  for (int r = 0; r < DIM; ++r) {
-    if (r % DIMBOX == 0) {
-      solution_print_separator();
-    }
-    for (int c = 0; c < DIM; ++c) {
-      if (c % DIMBOX == 0) {
-        printf("|");
+  // define and initialize fresh occupancy masks; the board's own masks are
+  //   not used because they are only trustworthy for boards built through
+  //   cell_fill
+  uint16_t row_seen[DIM] = { 0 };
+  uint16_t col_seen[DIM] = { 0 };
+  uint16_t box_seen[DIM] = { 0 };
+
+  for (int row = 0; row < DIM; ++row) {
+    for (int col = 0; col < DIM; ++col) {
+      // define and initialize the value of the current cell
+      int num = cells[row * DIM + col];
+
+      if (num == EMPTY) {
+        continue;
+      }
+      if (num < 1 || num > 9) {
+        return false;
+      }
+
+      // define and initialize the bit for num and the box of the cell
+      uint16_t bit = 1 << num;
+      int box = box_index(row, col);
+
+      // hitting a set bit in any of the three masks means num appears twice
+      //   within one group
+      if ((row_seen[row] | col_seen[col] | box_seen[box]) & bit) {
+        return false;
       }
-      printf(" %c ", PRINT[su->solution[r * DIM + c]]);
+      row_seen[row] |= bit;
+      col_seen[col] |= bit;
+      box_seen[box] |= bit;
     }
-    printf("|\n");
   }
-  solution_print_separator();
-  printf("\n");
+
+  return true;
 }
 
 // see sudoku.h for documentation
-void solution_reset(struct sudoku *su) {
+bool board_valid(const struct sudoku *su) {
+  assert(su);
+  return cells_valid(su->solution);
+}
+
+// see sudoku.h for documentation
+int sudoku_size(void) {
+  return sizeof(struct sudoku);
+}
+
+// see sudoku.h for documentation
+bool sudoku_reset_to(struct sudoku *su, const char *board81) {
+  assert(su);
+  assert(board81);
+
+  // define and initialize an array for the decoded cells, so su is only
+  //   touched once the whole string is known to be well formed
+  uint8_t cells[DIM * DIM];
+
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    char c = board81[pos];
+    if (c == '\0') {
+      return false;
+    }
+    if (c == PRINT[EMPTY] || c == '.' || c == '0') {
+      cells[pos] = EMPTY;
+    } else if ('1' <= c && c <= '9') {
+      cells[pos] = c - '0';
+    } else {
+      return false;
+    }
+  }
+
+  // reject boards whose givens already conflict; nothing downstream of an
+  //   external feed should have to re-discover a doubled digit
+  if (!cells_valid(cells)) {
+    return false;
+  }
+
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    su->puzzle[pos] = cells[pos];
+    su->solution[pos] = cells[pos];
+  }
+  masks_rebuild(su);
+  return true;
+}
+
+// see sudoku.h for documentation
+bool sudoku_init_from_string(struct sudoku *su, const char *board81) {
+  return sudoku_reset_to(su, board81);
+}
+
+// see sudoku.h for documentation
+bool sudoku_reset_to_cells(struct sudoku *su, const unsigned char *cells81) {
+  assert(su);
+  assert(cells81);
+
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    if (cells81[pos] > 9) {
+      return false;
+    }
+  }
+  if (!cells_valid(cells81)) {
+    return false;
+  }
+
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    su->puzzle[pos] = cells81[pos];
+    su->solution[pos] = cells81[pos];
+  }
+  masks_rebuild(su);
+  return true;
+}
+
+// see sudoku.h for documentation
+struct sudoku *sudoku_read_next(void) {
+  struct sudoku *su = malloc(sizeof(struct sudoku));
+  assert(su);
+  if (!sudoku_read_into(su)) {
+    free(su);
+    return NULL;
+  }
+  return su;
+}
+
+// see sudoku.h for documentation
+void sudoku_destroy(struct sudoku *su) {
+  assert(su);
+  free(su);
+}
+
+// PRINT_BUF_LEN is enough space for a rendered board: 13 lines of at most
+//   32 characters each, a blank line, and a terminator
+#define PRINT_BUF_LEN 512
+
+// render_separator(buf) writes a separator between boxes into buf and
+//   returns the number of characters written.
+// requires: buf has space for one separator line
+// effects: mutates buf
+static int render_separator(char *buf) {
+  assert(buf);
+
+  int len = 0;
+  for (int box = 0; box < DIM / DIMBOX; ++box) {
+    buf[len] = '+';
+    ++len;
+    for (int i = 0; i < 3 * DIMBOX; ++i) {
+      buf[len] = '-';
+      ++len;
+    }
+  }
+  buf[len] = '+';
+  ++len;
+  buf[len] = '\n';
+  ++len;
+  return len;
+}
+
+// see sudoku.h for documentation
+void solution_print(const struct sudoku *su) {
+  assert(su);
+
+  // the whole board is rendered into one stack buffer and written out with
+  //   a single call, instead of one printf per cell and separator dash
+  char buf[PRINT_BUF_LEN];
+  int len = 0;
+
+  for (int r = 0; r < DIM; ++r) {
+    if (r % DIMBOX == 0) {
+      len += render_separator(buf + len);
+    }
+    for (int c = 0; c < DIM; ++c) {
+      if (c % DIMBOX == 0) {
+        buf[len] = '|';
+        ++len;
+      }
+      buf[len] = ' ';
+      buf[len + 1] = PRINT[su->solution[r * DIM + c]];
+      buf[len + 2] = ' ';
+      len += 3;
+    }
+    buf[len] = '|';
+    buf[len + 1] = '\n';
+    len += 2;
+  }
+  len += render_separator(buf + len);
+  buf[len] = '\n';
+  ++len;
+
+  assert(len < PRINT_BUF_LEN);
+  fwrite(buf, 1, len, stdout);
+}
+
+// see sudoku.h for documentation
+void solution_print_compact(const struct sudoku *su) {
+  assert(su);
+
+  char buf[DIM * DIM + 1];
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    buf[pos] = PRINT[su->solution[pos]];
+  }
+  buf[DIM * DIM] = '\n';
+  fwrite(buf, 1, DIM * DIM + 1, stdout);
+}
+
+// see sudoku.h for documentation
+void solution_reset(struct sudoku *su) {
   assert(su);
   for (int row = 0; row < DIM; ++row) {
     for (int col = 0; col < DIM; ++col) {
       su->solution[row * DIM + col] = su->puzzle[row * DIM + col];
     }
-  }  
+  }
+  masks_rebuild(su);
 }
 
 // see sudoku.h for documentation
@@ -235,7 +1109,18 @@ bool cell_erase(struct sudoku *su, int row, int col) {
   if (su->puzzle[row * DIM + col] != EMPTY) {
     return false;
   } else {
+    // define and initialize the number currently stored in the cell, so that
+    //   its bits can be cleared from the masks before the cell is emptied
+    int old_num = su->solution[row * DIM + col];
+
+    if (old_num != EMPTY) {
+      masks_remove(su, row, col, old_num);
+      journal_record(su, row * DIM + col, old_num, EMPTY);
+    }
     su->solution[row * DIM + col] = EMPTY;
+    if (old_num != EMPTY) {
+      hint_cache_update(su, row * DIM + col);
+    }
     return true;
   }
 }
@@ -253,12 +1138,26 @@ bool cell_fill(struct sudoku *su, int row, int col, int num) {
     //   cannot put the number at this position
     return false;
   } else {
+    // define and initialize the number currently stored in the cell; its
+    //   bits have to leave the masks before num is checked, or a refilled
+    //   cell would be tested against its own old value forever
+    int old_num = su->solution[row * DIM + col];
+    if (old_num != EMPTY) {
+      masks_remove(su, row, col, old_num);
+    }
+
     // we check whether violate any of the row-, column-, or box-constraints
-    if (violate_row(su, row, num) || violate_col(su, col, num) || 
+    if (violate_row(su, row, num) || violate_col(su, col, num) ||
         violate_box(su, row, col, num)) {
+      if (old_num != EMPTY) {
+        masks_place(su, row, col, old_num);
+      }
       return false;
     } else {
       su->solution[row * DIM + col] = num;
+      masks_place(su, row, col, num);
+      journal_record(su, row * DIM + col, old_num, num);
+      hint_cache_update(su, row * DIM + col);
       return true;
     }
   }
@@ -295,6 +1194,9 @@ int cell_choices(const struct sudoku *su, int row, int col, int choices[]) {
   assert(0 <= row && row <= DIM - 1);
   assert(0 <= col && col <= DIM - 1);
 
+  STATS_BUMP(choice_calls);
+  PROF_COUNT(PROF_CELL_CHOICES);
+
   if (su->puzzle[row * DIM + col] != EMPTY) {
     // if the number at the given position is already provided then there is
     //   no choice to put any other number
@@ -303,11 +1205,16 @@ int cell_choices(const struct sudoku *su, int row, int col, int choices[]) {
     // define and initialize a number to record the number of choice we have
     int choice = 0;
 
+    // define and initialize the combined mask of all numbers already used in
+    //   the row, column, and box of the cell, so each number costs one bit
+    //   test instead of three constraint scans
+    uint16_t used = su->row_used[row] | su->col_used[col] |
+                    su->box_used[box_index(row, col)];
+
     // we check each number 1 to 9 to see how many choices do we have, and put
     //   the number into choices if it is valid
     for (int i = 1; i <= 9; ++i) {
-      if (violate_row(su, row, i) || violate_col(su, col, i) || 
-          violate_box(su, row, col, i)) {
+      if (used & (1 << i)) {
         continue;
       } else {
         choices[choice] = i;
@@ -320,46 +1227,342 @@ int cell_choices(const struct sudoku *su, int row, int col, int choices[]) {
 }
 
 // see sudoku.h for documentation
-// time: O(n)
+// time: O(n) where n is the length of su->solution
+void board_choices(const struct sudoku *su, uint16_t out[]) {
+  assert(su);
+  assert(out);
+
+  STATS_BUMP(choice_calls);
+
+  // one pass over the board: the 27 group masks already live in the
+  //   structure, so each cell's mask is two ORs against its row and column
+  //   masks plus one against its box mask, instead of 81 separate
+  //   cell_choices calls scanning 27 cells each. The loop body is branch-
+  //   free apart from the givens test, so the compiler can unroll and
+  //   vectorize it across a row.
+  for (int row = 0; row < DIM; ++row) {
+    // define and initialize the row mask once per row
+    uint16_t row_mask = su->row_used[row];
+
+    for (int col = 0; col < DIM; ++col) {
+      // define and initialize the position of the current cell
+      int pos = row * DIM + col;
+
+      if (su->solution[pos] != EMPTY) {
+        out[pos] = 0;
+      } else {
+        out[pos] = (uint16_t)(~(row_mask | su->col_used[col] |
+                                su->box_used[CELL_BOX[pos]]) &
+                              0x3fe);
+      }
+    }
+  }
+}
+
+// see sudoku.h for documentation
+// time: O(1) amortized
 bool cell_hint(const struct sudoku *su, int *row, int *col) {
   assert(su);
   assert(row);
   assert(col);
 
-  // check each element of su->solution and finds a hint for an empty position,
-  //   return true if there is only one choice for this position
-  for (int i = 0; i < DIM; ++i) {
-    for (int j = 0; j < DIM; ++j) {
-      if (su->solution[i * DIM + j] == EMPTY) {
-        // define and initialize a array to record the possible choices
-        int choices[DIM];
+  // the hint cache is invisible to the caller (no observable state of the
+  //   board depends on it), so filling it in behind a const pointer is fine
+  struct sudoku *cache = (struct sudoku *)su;
+  if (!su->cand_valid) {
+    hint_cache_rebuild(cache);
+  }
 
-        // define and initialize a number to record number of choices, and
-        //   modifies choices to record the possible solution
-        int num_choices = cell_choices(su, i, j, choices);
+  // every empty cell sits in the bucket for its candidate count, so the
+  //   next single (if any) is simply the head of bucket 1
+  if (su->bucket_head[1] < 0) {
+    return false;
+  }
+  *row = su->bucket_head[1] / DIM;
+  *col = su->bucket_head[1] % DIM;
+  return true;
+}
 
-        // if the number of choices is only 1, we modifies row and col to
-        //   record the indices of the cell, and function returns true
-        if (num_choices == 1) {
-          *row = i;
-          *col = j;
-          return true;
-        }
+// solve_at_depth(su, depth) runs one level of the propagate-then-branch
+//   search of sudoku_solve; depth only exists to feed the instrumentation
+//   counters. The function returns true if su has a valid solution, and
+//   false otherwise.
+// effects: might mutate *su
+// time: O(n^2)
+static bool solve_at_depth(struct sudoku *su, int depth) {
+  assert(su);
+
+  STATS_BUMP(nodes);
+  STATS_DEPTH(depth);
+
+  // a board state already proven unsolvable cannot become solvable; the
+  //   generator re-solves near-identical boards thousands of times, and
+  //   this check prunes those repeated subtrees at the cost of one lookup
+  if (cache_unsolvable(su->hash)) {
+    return false;
+  }
+
+  // define and initialize an array recording the cells the propagation stage
+  //   fills at this level, so they can be erased if the search below fails
+  int filled[DIM * DIM];
+  int num_filled = 0;
+
+  // fill every forced cell before guessing anything; most puzzles collapse
+  //   completely (or expose a contradiction) right here
+  if (propagate_singles(su, filled, &num_filled)) {
+    if (puzzle_solved(su)) {
+      return true;
+    }
+
+    // define and initialize numbers to record the row and col of the current
+    //   position we are looking at
+    int row = 0;
+    int col = 0;
+
+    // define and initialize an array of integer to store the choices
+    int choices[DIM];
+    // define and initialize a number to record the least number of possible
+    //   solutions
+    int least_num = least_possible_solutions(su, &row, &col, choices);
+
+    // verify all possible of the solutions
+    for (int i = 0; i < least_num; ++i) {
+      // define and initialize the current solution
+      int curr_sol = choices[i];
+
+      // fill in the cell with the solution
+      if (!cell_fill(su, row, col, curr_sol)) {
+        continue;
       }
+
+      // run Sudokusolve recursively
+      if (solve_at_depth(su, depth + 1)) {
+        return true;
+      }
+
+      // erase the failed guess before trying the next candidate, so its bits
+      //   do not linger in the row-, column-, and box-masks
+      STATS_BUMP(backtracks);
+      cell_erase(su, row, col);
     }
   }
 
+  // the branch failed: erase everything propagation filled at this level
+  for (int i = num_filled - 1; i >= 0; --i) {
+    cell_erase(su, filled[i] / DIM, filled[i] % DIM);
+  }
+  // the search below this state was exhaustive, so the verdict is
+  //   definitive and worth remembering across calls
+  cache_record(su->hash);
   return false;
 }
 
+// see sudoku.h for documentation
+void sudoku_journal_enable(struct sudoku *su) {
+  assert(su);
+  su->journal_on = true;
+}
+
+// see sudoku.h for documentation
+bool sudoku_undo(struct sudoku *su) {
+  assert(su);
+
+  if (su->journal_cur == 0) {
+    return false;
+  }
+  --su->journal_cur;
+  set_cell_raw(su, su->journal[su->journal_cur].pos,
+               su->journal[su->journal_cur].old_val);
+  return true;
+}
+
+// see sudoku.h for documentation
+long sudoku_snapshot(struct sudoku *su) {
+  assert(su);
+
+  // snapshots ride on the journal, so it has to be recording
+  su->journal_on = true;
+  return su->journal_dropped + su->journal_cur;
+}
+
+// see sudoku.h for documentation
+bool sudoku_restore(struct sudoku *su, long snap) {
+  assert(su);
+
+  // define and initialize the journal cursor the token corresponds to now
+  //   that journal_dropped entries have fallen off the front
+  long target = snap - su->journal_dropped;
+  if (target < 0 || target > su->journal_len) {
+    // the snapshot predates the retained history (or a board load, which
+    //   resets both counters and so invalidates every older token)
+    return false;
+  }
+
+  // walk the delta log to the target, so the cost is proportional to the
+  //   changes made (or undone) since the snapshot, not to the board size
+  while (su->journal_cur > target) {
+    sudoku_undo(su);
+  }
+  while (su->journal_cur < target) {
+    sudoku_redo(su);
+  }
+  return true;
+}
+
+// see sudoku.h for documentation
+bool sudoku_redo(struct sudoku *su) {
+  assert(su);
+
+  if (su->journal_cur == su->journal_len) {
+    return false;
+  }
+  set_cell_raw(su, su->journal[su->journal_cur].pos,
+               su->journal[su->journal_cur].new_val);
+  ++su->journal_cur;
+  return true;
+}
+
 // see sudoku.h for documentation
 // time: O(n^2)
 bool sudoku_solve(struct sudoku *su) {
   assert(su);
 
-  if (puzzle_solved(su)) {
-    return true;
-  } else {
+  // the search fills and erases cells thousands of times; none of that
+  //   belongs in the player's undo history, and maintaining the hint cache
+  //   through it would cost a 21-cell refresh per fill
+  bool journal_was_on = su->journal_on;
+  su->journal_on = false;
+  su->cand_valid = false;
+  PROF_DECL(prof_t0);
+  bool solved = solve_at_depth(su, 0);
+  PROF_TIME(PROF_SOLVE, prof_t0);
+  su->journal_on = journal_was_on;
+  return solved;
+}
+
+// count_at_level(su, limit, found) runs one level of the solution-counting
+//   search: the same propagate-then-branch step as solve_at_depth, except
+//   that finding a solution bumps found and keeps searching until found
+//   reaches limit. Unlike solve_at_depth, every fill is undone before the
+//   function returns, so the board comes back unchanged.
+// requires: found is a valid pointer
+// effects: mutates *su during the search (restored on return)
+//          might mutate *found
+static void count_at_level(struct sudoku *su, int limit, int *found) {
+  assert(su);
+  assert(found);
+
+  // an unsolvable state contributes no solutions, however it was reached
+  if (cache_unsolvable(su->hash)) {
+    return;
+  }
+  // define and initialize the count on entry, so a fruitless exhaustive
+  //   level can be recorded as unsolvable on the way out
+  int found_before = *found;
+
+  // define and initialize an array recording the cells the propagation stage
+  //   fills at this level, so they are always erased again on the way out
+  int filled[DIM * DIM];
+  int num_filled = 0;
+
+  if (propagate_singles(su, filled, &num_filled)) {
+    if (puzzle_solved(su)) {
+      ++*found;
+    } else {
+      // define and initialize numbers to record the row and col of the
+      //   current position we are looking at
+      int row = 0;
+      int col = 0;
+
+      // define and initialize an array of integer to store the choices
+      int choices[DIM];
+      // define and initialize a number to record the least number of
+      //   possible solutions
+      int least_num = least_possible_solutions(su, &row, &col, choices);
+
+      for (int i = 0; i < least_num && *found < limit; ++i) {
+        if (!cell_fill(su, row, col, choices[i])) {
+          continue;
+        }
+        count_at_level(su, limit, found);
+        cell_erase(su, row, col);
+      }
+    }
+  }
+
+  // erase everything propagation filled at this level, whether the branch
+  //   produced solutions or not
+  for (int i = num_filled - 1; i >= 0; --i) {
+    cell_erase(su, filled[i] / DIM, filled[i] % DIM);
+  }
+
+  if (*found == found_before && *found < limit) {
+    // no solutions below this state and the limit never cut the search
+    //   short, so the state is definitively unsolvable
+    cache_record(su->hash);
+  }
+}
+
+// next_random(state) advances a small xorshift generator and returns the new
+//   state. The generator lives here (instead of rand()) so generation is
+//   reproducible from a seed and safe to run on several threads at once.
+// requires: state is a valid pointer
+// effects: mutates *state
+// time: O(1)
+static unsigned int next_random(unsigned int *state) {
+  assert(state);
+  unsigned int x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  // avoid the all-zero fixed point
+  if (x == 0) {
+    x = 0x9e3779b9;
+  }
+  *state = x;
+  return x;
+}
+
+// shuffle_ints(arr, len, state) puts arr (with a length of len) into a
+//   random order driven by state.
+// requires: len is non-negative
+//           state is a valid pointer
+// effects: mutates arr and *state
+// time: O(n)
+static void shuffle_ints(int arr[], int len, unsigned int *state) {
+  assert(arr);
+  assert(state);
+
+  for (int i = len - 1; i > 0; --i) {
+    int j = next_random(state) % (i + 1);
+    int tmp = arr[i];
+    arr[i] = arr[j];
+    arr[j] = tmp;
+  }
+}
+
+// fill_random(su, state) completes the board with the same propagate-then-
+//   branch search as solve_at_depth, but tries the candidates of each branch
+//   cell in an order shuffled by state, so repeated runs produce different
+//   full grids. The function returns true if the board was completed, and
+//   false otherwise.
+// requires: state is a valid pointer
+// effects: might mutate *su and *state
+// time: O(n^2)
+static bool fill_random(struct sudoku *su, unsigned int *state) {
+  assert(su);
+  assert(state);
+
+  // define and initialize an array recording the cells the propagation stage
+  //   fills at this level, so they can be erased if the search below fails
+  int filled[DIM * DIM];
+  int num_filled = 0;
+
+  if (propagate_singles(su, filled, &num_filled)) {
+    if (puzzle_solved(su)) {
+      return true;
+    }
+
     // define and initialize numbers to record the row and col of the current
     //   position we are looking at
     int row = 0;
@@ -371,28 +1574,655 @@ bool sudoku_solve(struct sudoku *su) {
     //   solutions
     int least_num = least_possible_solutions(su, &row, &col, choices);
 
-    if (least_num == 0) {
-      return false;
+    shuffle_ints(choices, least_num, state);
+
+    for (int i = 0; i < least_num; ++i) {
+      if (!cell_fill(su, row, col, choices[i])) {
+        continue;
+      }
+      if (fill_random(su, state)) {
+        return true;
+      }
+      cell_erase(su, row, col);
+    }
+  }
+
+  for (int i = num_filled - 1; i >= 0; --i) {
+    cell_erase(su, filled[i] / DIM, filled[i] % DIM);
+  }
+  return false;
+}
+
+// SUDOKU_RESTART_UNIT is the backtrack budget of the first restart run;
+//   run i gets luby(i) times this many backtracks before it is abandoned
+#define SUDOKU_RESTART_UNIT 64
+
+// luby(i) returns the i-th term (starting at 1) of the Luby restart
+//   sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...; budgets
+//   scaled by this sequence are the classic cure for heavy-tailed
+//   backtracking runtimes.
+// requires: i is positive
+// time: O(log i) amortized
+static long long luby(long long i) {
+  assert(i > 0);
+
+  // define and initialize the smallest k with 2^k - 1 >= i
+  long long k = 1;
+  while ((1LL << k) - 1 < i) {
+    ++k;
+  }
+  // peel complete subsequences off the front until i lands exactly on the
+  //   last position of one, whose value is 2^(k-1)
+  while ((1LL << k) - 1 != i) {
+    i -= (1LL << (k - 1)) - 1;
+    k = 1;
+    while ((1LL << k) - 1 < i) {
+      ++k;
+    }
+  }
+  return 1LL << (k - 1);
+}
+
+// solve_random_at(su, state, budget) runs one level of the restart solver:
+//   the same propagate-then-branch step as solve_at_depth, but with the
+//   candidates of the branch cell tried in an order shuffled by state, and
+//   with the search abandoned once budget backtracks have been spent. The
+//   function returns SUDOKU_SOLVED, SUDOKU_UNSOLVABLE (the level was
+//   searched exhaustively), or SUDOKU_TIMEOUT (the budget ran out); unless
+//   it solved the puzzle, every fill is undone before it returns.
+// requires: state and budget are valid pointers
+// effects: might mutate *su, *state, and *budget
+// time: O(n^2)
+static int solve_random_at(struct sudoku *su, unsigned int *state,
+                           long long *budget) {
+  assert(su);
+  assert(state);
+  assert(budget);
+
+  if (cache_unsolvable(su->hash)) {
+    return SUDOKU_UNSOLVABLE;
+  }
+
+  // define and initialize an array recording the cells the propagation stage
+  //   fills at this level, so they can be erased if the search below fails
+  int filled[DIM * DIM];
+  int num_filled = 0;
+
+  // define and initialize the outcome of this level
+  int rc = SUDOKU_UNSOLVABLE;
+
+  if (propagate_singles(su, filled, &num_filled)) {
+    if (puzzle_solved(su)) {
+      return SUDOKU_SOLVED;
+    }
+
+    // define and initialize numbers to record the row and col of the current
+    //   position we are looking at
+    int row = 0;
+    int col = 0;
+
+    // define and initialize an array of integer to store the choices
+    int choices[DIM];
+    // define and initialize a number to record the least number of possible
+    //   solutions
+    int least_num = least_possible_solutions(su, &row, &col, choices);
+
+    // the shuffle is the whole point: a deterministic ascending order is
+    //   exactly what adversarial clue patterns exploit
+    shuffle_ints(choices, least_num, state);
+
+    for (int i = 0; i < least_num; ++i) {
+      if (!cell_fill(su, row, col, choices[i])) {
+        continue;
+      }
+      rc = solve_random_at(su, state, budget);
+      if (rc == SUDOKU_SOLVED) {
+        return SUDOKU_SOLVED;
+      }
+      cell_erase(su, row, col);
+      if (rc == SUDOKU_TIMEOUT) {
+        break;
+      }
+
+      STATS_BUMP(backtracks);
+      --*budget;
+      if (*budget < 0) {
+        rc = SUDOKU_TIMEOUT;
+        break;
+      }
+    }
+  }
+
+  // the branch failed or timed out: erase everything propagation filled at
+  //   this level so the board is clean for the next restart
+  for (int i = num_filled - 1; i >= 0; --i) {
+    cell_erase(su, filled[i] / DIM, filled[i] % DIM);
+  }
+  if (rc == SUDOKU_UNSOLVABLE) {
+    // only an exhaustive failure is definitive; a timeout proves nothing
+    cache_record(su->hash);
+  }
+  return rc;
+}
+
+// see sudoku.h for documentation
+bool sudoku_solve_restart(struct sudoku *su, unsigned int seed) {
+  assert(su);
+
+  // like sudoku_solve, the search must not pollute the undo history or
+  //   maintain the hint cache
+  bool journal_was_on = su->journal_on;
+  su->journal_on = false;
+  su->cand_valid = false;
+
+  // define and initialize the generator state; seed 0 would stick, so it is
+  //   nudged off zero
+  unsigned int state = seed ? seed : 1;
+
+  // define and initialize the overall outcome, filled in by the runs below
+  bool solved = false;
+  for (long long run = 1; ; ++run) {
+    // define and initialize this run's backtrack budget from the Luby
+    //   sequence; budgets grow without bound, so some run always finishes
+    long long budget = SUDOKU_RESTART_UNIT * luby(run);
+
+    int rc = solve_random_at(su, &state, &budget);
+    if (rc == SUDOKU_SOLVED) {
+      solved = true;
+      break;
+    }
+    if (rc == SUDOKU_UNSOLVABLE) {
+      // the run searched the whole space within its budget, so the answer
+      //   is definitive, not an artifact of the ordering
+      break;
+    }
+    // timed out: the board is back in its starting state, and the advanced
+    //   generator state reshuffles every branch of the next run
+  }
+
+  su->journal_on = journal_was_on;
+  return solved;
+}
+
+// see sudoku.h for documentation
+int sudoku_generate(struct sudoku *su, int target_clues, unsigned int seed) {
+  assert(su);
+  assert(target_clues > 0);
+
+  // define and initialize the generator state; seed 0 would stick, so it is
+  //   nudged off zero
+  unsigned int state = seed ? seed : 1;
+
+  // start from an empty board and complete it in a random order; an empty
+  //   board always has solutions, so this cannot fail
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    su->puzzle[pos] = EMPTY;
+    su->solution[pos] = EMPTY;
+  }
+  masks_rebuild(su);
+  assert(fill_random(su, &state));
+
+  // the full grid becomes the starting point: every cell is a clue
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    su->puzzle[pos] = su->solution[pos];
+  }
+  int clues = DIM * DIM;
+
+  // define and initialize the cell positions in a random order; each is
+  //   tried once as a removal candidate
+  int order[DIM * DIM];
+  for (int pos = 0; pos < DIM * DIM; ++pos) {
+    order[pos] = pos;
+  }
+  shuffle_ints(order, DIM * DIM, &state);
+
+  for (int i = 0; i < DIM * DIM && clues > target_clues; ++i) {
+    // define and initialize the position and value of the clue to try
+    int pos = order[i];
+    int num = su->puzzle[pos];
+
+    // remove the clue, then put it back if the puzzle stops being unique
+    su->puzzle[pos] = EMPTY;
+    su->solution[pos] = EMPTY;
+    masks_remove(su, pos / DIM, pos % DIM, num);
+
+    if (sudoku_count_solutions(su, 2) != 1) {
+      su->puzzle[pos] = num;
+      su->solution[pos] = num;
+      masks_place(su, pos / DIM, pos % DIM, num);
     } else {
-      // verify all possible of the solutions
-      for (int i = 0; i < least_num; ++i) {
-        // define and initialize the current solution
-        int curr_sol = choices[i];
+      --clues;
+    }
+  }
 
-        // fill in the cell with the solution
-        if (!cell_fill(su, row, col, curr_sol)) {
-          continue;
-        }
+  return clues;
+}
+
+// see sudoku.h for documentation
+int sudoku_count_solutions(struct sudoku *su, int limit) {
+  assert(su);
+  assert(limit > 0);
+
+  // define and initialize the number of solutions found so far
+  int found = 0;
+  // counting explores the board the same way the solver does; keep the
+  //   churn out of the undo history
+  bool journal_was_on = su->journal_on;
+  su->journal_on = false;
+  su->cand_valid = false;
+  count_at_level(su, limit, &found);
+  su->journal_on = journal_was_on;
+  return found;
+}
+
+// see sudoku.h for documentation
+bool sudoku_solve_stats(struct sudoku *su, struct sudoku_stats *stats) {
+  assert(su);
+  assert(stats);
+
+  stats->nodes = 0;
+  stats->backtracks = 0;
+  stats->choice_calls = 0;
+  stats->propagation_passes = 0;
+  stats->max_depth = 0;
+  stats->wall_usec = 0;
+
+  bool journal_was_on = su->journal_on;
+  su->journal_on = false;
+  su->cand_valid = false;
+
+#ifndef SUDOKU_NOSTATS
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  active_stats = stats;
+
+  bool solved = solve_at_depth(su, 0);
+
+  active_stats = NULL;
+  su->journal_on = journal_was_on;
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  stats->wall_usec = (end.tv_sec - start.tv_sec) * 1000000LL +
+                     (end.tv_nsec - start.tv_nsec) / 1000;
+  return solved;
+#else
+  bool solved = solve_at_depth(su, 0);
+  su->journal_on = journal_was_on;
+  return solved;
+#endif
+}
+
+// a frame is one level of the iterative search: the cells singles
+//   propagation filled when the level was entered, the cell being branched
+//   on, its possible values, and the index of the next value to try
+struct frame {
+  // the cells propagate_singles filled at this level, so backtracking can
+  //   erase them together with the guess made below them
+  int filled[DIM * DIM];
+  int num_filled;
+  int pos;
+  int choices[DIM];
+  int num_choices;
+  int next;
+};
 
-        // run Sudokusolve recursively
-        if (sudoku_solve(su)) {
-          return true;
+// see sudoku.h for documentation
+// time: O(n^2)
+bool sudoku_solve_iter(struct sudoku *su) {
+  assert(su);
+
+  if (puzzle_solved(su)) {
+    return true;
+  }
+
+  // like sudoku_solve, the search must not pollute the undo history or
+  //   maintain the hint cache
+  bool journal_was_on = su->journal_on;
+  su->journal_on = false;
+  su->cand_valid = false;
+
+  // define and initialize the decision stack; the search fills one cell per
+  //   level, so it can never be deeper than the number of cells
+  struct frame stack[DIM * DIM];
+  // depth is the index of the frame currently being worked on
+  int depth = 0;
+  // advancing is true when the frame at depth still has to be created, and
+  //   false when we returned to an existing frame by backtracking
+  bool advancing = true;
+
+  while (1) {
+    struct frame *f = &stack[depth];
+
+    if (advancing) {
+      // fill every forced cell before guessing, exactly like the recursive
+      //   search; a contradiction makes this a dead branch (zero choices),
+      //   and the backtracking path below erases the fills again
+      f->num_filled = 0;
+      f->next = 0;
+      if (!propagate_singles(su, f->filled, &f->num_filled)) {
+        f->num_choices = 0;
+      } else if (puzzle_solved(su)) {
+        su->journal_on = journal_was_on;
+        return true;
+      } else {
+        // define and initialize numbers to record the row and col of the
+        //   cell with the least possible solutions
+        int row = 0;
+        int col = 0;
+
+        f->num_choices = least_possible_solutions(su, &row, &col, f->choices);
+        f->pos = row * DIM + col;
+      }
+    }
+
+    if (f->next >= f->num_choices) {
+      // all candidates at this level failed (or the branch was dead): undo
+      //   this level's propagation fills and the parent's guess, and
+      //   continue with the parent's next candidate
+      for (int k = f->num_filled - 1; k >= 0; --k) {
+        cell_erase(su, f->filled[k] / DIM, f->filled[k] % DIM);
+      }
+      if (depth == 0) {
+        su->journal_on = journal_was_on;
+        return false;
+      }
+      --depth;
+      struct frame *parent = &stack[depth];
+      cell_erase(su, parent->pos / DIM, parent->pos % DIM);
+      advancing = false;
+      continue;
+    }
+
+    // define and initialize the current solution
+    int curr_sol = f->choices[f->next];
+    ++f->next;
+
+    // fill in the cell with the solution
+    if (!cell_fill(su, f->pos / DIM, f->pos % DIM, curr_sol)) {
+      advancing = false;
+      continue;
+    }
+
+    if (puzzle_solved(su)) {
+      su->journal_on = journal_was_on;
+      return true;
+    }
+
+    // descend one level and branch on the next cell
+    ++depth;
+    advancing = true;
+  }
+}
+
+// a sudoku_search carries the paused decision stack of a bounded solve, so
+//   a later call can pick the search up exactly where the budget ran out
+struct sudoku_search {
+  // active records whether the stack below continues an earlier call
+  bool active;
+  // depth is the index of the frame the search was working on
+  int depth;
+  // advancing mirrors the flag of the same name in sudoku_solve_iter
+  bool advancing;
+  struct frame stack[DIM * DIM];
+};
+
+// see sudoku.h for documentation
+int sudoku_search_size(void) {
+  return sizeof(struct sudoku_search);
+}
+
+// see sudoku.h for documentation
+void sudoku_search_begin(struct sudoku_search *state) {
+  assert(state);
+  state->active = false;
+}
+
+// see sudoku.h for documentation
+int sudoku_solve_bounded(struct sudoku *su, long long max_nodes,
+                         struct sudoku_search *state) {
+  assert(su);
+  assert(max_nodes > 0);
+
+  // define and initialize a scratch state for one-shot calls that did not
+  //   pass a snapshot of their own
+  struct sudoku_search local;
+  local.active = false;
+  if (!state) {
+    state = &local;
+  }
+
+  // like sudoku_solve, the search must not pollute the undo history or
+  //   maintain the hint cache
+  bool journal_was_on = su->journal_on;
+  su->journal_on = false;
+  su->cand_valid = false;
+
+  // define and initialize the current frame index and the advancing flag,
+  //   either fresh or from the paused search being resumed
+  int depth = 0;
+  bool advancing = true;
+  if (state->active) {
+    depth = state->depth;
+    advancing = state->advancing;
+  } else if (puzzle_solved(su)) {
+    su->journal_on = journal_was_on;
+    return SUDOKU_SOLVED;
+  }
+
+  // define and initialize the number of search steps taken in this call
+  long long nodes = 0;
+
+  while (1) {
+    if (nodes >= max_nodes) {
+      if (state == &local) {
+        // nobody can resume this search, so undo every fill and give the
+        //   caller the board back unchanged: the current frame's
+        //   propagation fills (if the frame was created), then each lower
+        //   frame's guess and propagation fills
+        if (!advancing) {
+          struct frame *f = &state->stack[depth];
+          for (int k = f->num_filled - 1; k >= 0; --k) {
+            cell_erase(su, f->filled[k] / DIM, f->filled[k] % DIM);
+          }
+        }
+        for (int d = depth - 1; d >= 0; --d) {
+          struct frame *f = &state->stack[d];
+          cell_erase(su, f->pos / DIM, f->pos % DIM);
+          for (int k = f->num_filled - 1; k >= 0; --k) {
+            cell_erase(su, f->filled[k] / DIM, f->filled[k] % DIM);
+          }
         }
+      } else {
+        state->active = true;
+        state->depth = depth;
+        state->advancing = advancing;
       }
+      su->journal_on = journal_was_on;
+      return SUDOKU_TIMEOUT;
+    }
+    ++nodes;
 
-      // erase changes
-      cell_erase(su, row, col);
-      return false;
+    struct frame *f = &state->stack[depth];
+
+    if (advancing) {
+      // fill every forced cell before guessing, exactly like the recursive
+      //   search; a contradiction makes this a dead branch (zero choices),
+      //   and the backtracking path below erases the fills again
+      f->num_filled = 0;
+      f->next = 0;
+      if (!propagate_singles(su, f->filled, &f->num_filled)) {
+        f->num_choices = 0;
+      } else if (puzzle_solved(su)) {
+        state->active = false;
+        su->journal_on = journal_was_on;
+        return SUDOKU_SOLVED;
+      } else {
+        // define and initialize numbers to record the row and col of the
+        //   cell with the least possible solutions
+        int row = 0;
+        int col = 0;
+
+        f->num_choices = least_possible_solutions(su, &row, &col, f->choices);
+        f->pos = row * DIM + col;
+      }
+    }
+
+    if (f->next >= f->num_choices) {
+      // all candidates at this level failed (or the branch was dead): undo
+      //   this level's propagation fills and the parent's guess, and
+      //   continue with the parent's next candidate
+      for (int k = f->num_filled - 1; k >= 0; --k) {
+        cell_erase(su, f->filled[k] / DIM, f->filled[k] % DIM);
+      }
+      if (depth == 0) {
+        state->active = false;
+        su->journal_on = journal_was_on;
+        return SUDOKU_UNSOLVABLE;
+      }
+      --depth;
+      struct frame *parent = &state->stack[depth];
+      cell_erase(su, parent->pos / DIM, parent->pos % DIM);
+      advancing = false;
+      continue;
+    }
+
+    // define and initialize the current solution
+    int curr_sol = f->choices[f->next];
+    ++f->next;
+
+    // fill in the cell with the solution
+    if (!cell_fill(su, f->pos / DIM, f->pos % DIM, curr_sol)) {
+      advancing = false;
+      continue;
+    }
+
+    if (puzzle_solved(su)) {
+      state->active = false;
+      su->journal_on = journal_was_on;
+      return SUDOKU_SOLVED;
+    }
+
+    // descend one level and branch on the next cell
+    ++depth;
+    advancing = true;
+  }
+}
+
+// see sudoku.h for documentation
+bool sudoku_cache_init(long entries) {
+  assert(entries > 0);
+
+  sudoku_cache_free();
+  tables_ensure();
+
+  // round the request down to a power of two so indexing is a mask
+  long rounded = 1;
+  while (rounded * 2 <= entries) {
+    rounded *= 2;
+  }
+
+  // calloc's zero fill is a valid initial value for a lock-free atomic
+  //   64-bit slot on every target this builds for
+  cache_slots = calloc(rounded, sizeof(_Atomic uint64_t));
+  if (!cache_slots) {
+    return false;
+  }
+  cache_index_mask = (uint64_t)rounded - 1;
+  return true;
+}
+
+// see sudoku.h for documentation
+void sudoku_cache_free(void) {
+  free(cache_slots);
+  cache_slots = NULL;
+  cache_index_mask = 0;
+}
+
+// see sudoku.h for documentation
+int sudoku_rate(struct sudoku *su) {
+  assert(su);
+
+  // rate a scratch copy so the caller's board (and its journal and hint
+  //   cache) come through untouched
+  struct sudoku *scratch = malloc(sudoku_size());
+  assert(scratch);
+  *scratch = *su;
+
+  // define and initialize the effort counters of one full solve
+  struct sudoku_stats stats;
+  bool solved = sudoku_solve_stats(scratch, &stats);
+  free(scratch);
+
+  if (!solved) {
+    return SUDOKU_RATING_UNSOLVABLE;
+  }
+  if (stats.nodes <= 1) {
+    // the root level finished the board: naked and hidden singles suffice
+    return SUDOKU_RATING_SINGLES;
+  }
+  if (stats.backtracks == 0) {
+    // branching was needed, but no guess ever had to be undone
+    return SUDOKU_RATING_EASY;
+  }
+  if (stats.backtracks <= 64) {
+    return SUDOKU_RATING_MEDIUM;
+  }
+  return SUDOKU_RATING_HARD;
+}
+
+// see sudoku.h for documentation
+const char *sudoku_rating_name(int rating) {
+  if (rating == SUDOKU_RATING_SINGLES) {
+    return "singles";
+  }
+  if (rating == SUDOKU_RATING_EASY) {
+    return "easy";
+  }
+  if (rating == SUDOKU_RATING_MEDIUM) {
+    return "medium";
+  }
+  if (rating == SUDOKU_RATING_HARD) {
+    return "hard";
+  }
+  return "unsolvable";
+}
+
+// see sudoku.h for documentation
+void sudoku_profile_print(void) {
+#ifdef SUDOKU_PROFILE
+  // define and initialize the tick total of the timed sites, so each bar
+  //   can show its share of the measured time
+  long long total = 0;
+  for (int i = 0; i < PROF_NUM_SITES; ++i) {
+    total += prof_sites[i].ticks;
+  }
+
+  printf("%-26s %14s %16s %12s\n", "site", "calls", "ticks", "ticks/call");
+  for (int i = 0; i < PROF_NUM_SITES; ++i) {
+    long long calls = prof_sites[i].calls;
+    long long ticks = prof_sites[i].ticks;
+    printf("%-26s %14lld %16lld %12lld  ", PROF_NAMES[i], calls, ticks,
+           calls > 0 ? ticks / calls : 0);
+
+    // the histogram bar: forty columns split by share of the timed total
+    //   (count-only sites have no ticks and so no bar)
+    int width = total > 0 ? (int)(ticks * 40 / total) : 0;
+    for (int k = 0; k < width; ++k) {
+      printf("#");
     }
+    printf("\n");
+  }
+#else
+  printf("profiling not compiled in; rebuild with -DSUDOKU_PROFILE\n");
+#endif
+}
+
+// see sudoku.h for documentation
+void sudoku_profile_reset(void) {
+#ifdef SUDOKU_PROFILE
+  for (int i = 0; i < PROF_NUM_SITES; ++i) {
+    prof_sites[i].calls = 0;
+    prof_sites[i].ticks = 0;
   }
+#endif
 }
@@ -1,4 +1,8 @@
+#ifndef SUDOKU_H
+#define SUDOKU_H
+
 #include <stdbool.h>
+#include <stdint.h>
 
 // sudoku holds all information required to play
 struct sudoku;
@@ -11,6 +15,54 @@ struct sudoku;
 //			    allocates memory (client must call sudoku_destroy)
 struct sudoku *sudoku_read(void);
 
+// sudoku_read_into(su) reads the next Sudoku puzzle from input into su,
+//   reusing the existing structure instead of allocating a new one. The
+//   function returns true if a complete puzzle was read, and false if the
+//   input is exhausted.
+// requires: su is a valid pointer
+// effects: reads from input
+//          might mutate su
+bool sudoku_read_into(struct sudoku *su);
+
+// sudoku_read_next() reads the next Sudoku puzzle from input and returns a
+//   pointer to a new sudoku structure, or NULL if the input is exhausted.
+// effects: reads from input
+//          might allocate memory (client must call sudoku_destroy)
+struct sudoku *sudoku_read_next(void);
+
+// sudoku_size() returns the number of bytes of storage one sudoku structure
+//   needs, so callers that manage their own memory (a stack buffer, arena,
+//   or per-thread pool) can place boards without any heap allocation.
+// time: O(1)
+int sudoku_size(void);
+
+// sudoku_init_from_string(su, board81) initializes the caller-owned
+//   structure su from board81, a string of 81 cell characters in reading
+//   order ('1' to '9' for given cells; '_', '.', or '0' for empty cells).
+//   The function returns true if board81 is well formed and its givens do
+//   not conflict, and false otherwise (su is left unchanged on failure).
+// requires: su and board81 are valid pointers
+//           su points to at least sudoku_size() bytes of storage
+// effects: might mutate su
+bool sudoku_init_from_string(struct sudoku *su, const char *board81);
+
+// sudoku_reset_to_cells(su, cells81) replaces the puzzle held by su with 81
+//   raw cell values (0 for empty, 1 to 9 for givens) in reading order, as
+//   stored in a packed binary corpus record. The function returns true if
+//   every value is legal and the givens do not conflict, and false
+//   otherwise (su is left unchanged on failure).
+// requires: su and cells81 are valid pointers
+// effects: might mutate su
+bool sudoku_reset_to_cells(struct sudoku *su, const unsigned char *cells81);
+
+// sudoku_reset_to(su, board81) replaces the puzzle held by su with board81
+//   (same format as sudoku_init_from_string), so one board can be reused
+//   across many puzzles. The function returns true if board81 is well
+//   formed, and false otherwise (su is left unchanged on failure).
+// requires: su and board81 are valid pointers
+// effects: might mutate su
+bool sudoku_reset_to(struct sudoku *su, const char *board81);
+
 // sudoku_destroy(su) frees all memory for su
 // effects: su is no longer valid
 void sudoku_destroy(struct sudoku *su);
@@ -19,6 +71,12 @@ void sudoku_destroy(struct sudoku *su);
 // effects: produces output
 void solution_print(const struct sudoku *su);
 
+// solution_print_compact(su) prints the current solution as a single line of
+//   81 cell characters ('1' to '9', or '_' for empty cells) for machine
+//   consumption.
+// effects: produces output
+void solution_print_compact(const struct sudoku *su);
+
 // solution_reset(su) resets the solution to be the initial puzzle.
 // effects: mutates su
 void solution_reset(struct sudoku *su);
@@ -41,7 +99,17 @@ bool cell_erase(struct sudoku *su, int row, int col);
 // the function will run at most 27 iterations in the worsest case
 bool cell_fill(struct sudoku *su, int row, int col, int num);
 
-// puzzle_solved(su) returns true if su holds a valid solution to the puzzle, 
+// board_valid(su) returns true if the current solution violates none of the
+//   row-, column-, or box-constraints and every cell holds a legal value,
+//   and false otherwise. Unlike puzzle_solved, this makes no assumption
+//   that the board was built through cell_fill, so it is the right check
+//   for boards loaded from external sources; empty cells are allowed.
+// time: O(n) where n is the length of su->solution
+// the function makes a single pass over the board, marking each value in
+//   per-row, per-column, and per-box bitmasks and failing on a repeat
+bool board_valid(const struct sudoku *su);
+
+// puzzle_solved(su) returns true if su holds a valid solution to the puzzle,
 //   and false otherwise.
 // time: O(n) where n is the length of su->solution
 // the function will check all elements in su->solution
@@ -57,14 +125,28 @@ bool puzzle_solved(const struct sudoku *su);
 // time: O(1)
 int cell_choices(const struct sudoku *su, int row, int col, int choices[]);
 
+// board_choices(su, out) computes the candidate mask of every cell in one
+//   pass: out[pos] has bit num set if num can legally go in cell pos, and
+//   is 0 for cells that already hold a value. The 27 group masks are read
+//   once and each cell's mask is three ORs and a complement, so rendering
+//   pencil marks for the whole board after a move costs one board scan
+//   instead of 81 cell_choices calls.
+// requires: out is a valid array of length 81
+// effects: mutates out
+// time: O(n) where n is the length of su->solution
+void board_choices(const struct sudoku *su, uint16_t out[]);
+
 // cell_hint(su, row, col) tries to find a cell that has only one possible
 //   value. If such a cell exists, the function mutates row and col to be the
 //   indices of that cell. The function returns true if such a cell exists,
 //   and false otherwise.
 // requires: row and col are valid pointers.
 // effects:  might mutate row and col
-// time: O(n) where n is the length of su->solution
-// the functions will check each elements in su->solution one by one
+// time: O(1) amortized
+// the function answers from a cached per-cell candidate table kept in step
+//   with fills and erases (only the 20 peers of a changed cell are
+//   refreshed), so calling hint after every move costs no board rescans;
+//   the cache is rebuilt in one O(n) pass after a board load or a solve
 bool cell_hint(const struct sudoku *su, int *row, int *col);
 
 // sudoku_solve(su) solves the Sudoku puzzle using search and backtracking. The
@@ -74,4 +156,220 @@ bool cell_hint(const struct sudoku *su, int *row, int *col);
 // the function will proceed the function puzzle_solved firstly, and then check
 //   each elements in su->solution and try to find the answer, so the running
 //   time will be O(n) + T(n-k) = O(n^2)
-bool sudoku_solve(struct sudoku *su);\
+bool sudoku_solve(struct sudoku *su);
+
+// sudoku_journal_enable(su) starts recording fills and erases in su's
+//   change journal, so they can be rolled back and forward with
+//   sudoku_undo and sudoku_redo. Loading a new puzzle into su stops and
+//   clears the journal; solver runs never touch it.
+// effects: mutates su
+void sudoku_journal_enable(struct sudoku *su);
+
+// sudoku_undo(su) rolls back the most recent journaled fill or erase. The
+//   function returns true if a change was undone, and false if there is
+//   nothing to undo.
+// effects: might mutate su
+// time: O(1)
+bool sudoku_undo(struct sudoku *su);
+
+// sudoku_redo(su) re-applies the most recently undone change. The function
+//   returns true if a change was redone, and false if there is nothing to
+//   redo.
+// effects: might mutate su
+// time: O(1)
+bool sudoku_redo(struct sudoku *su);
+
+// sudoku_snapshot(su) returns a token for the board's current state, for
+//   cheap what-if exploration: speculative fills and erases can later be
+//   rolled back with sudoku_restore at a cost proportional to the cells
+//   actually touched, with no copy of the board ever made. The token is a
+//   position in the change journal, so taking one is O(1) and turns
+//   journaling on if it was off.
+// effects: might mutate su
+// time: O(1)
+long sudoku_snapshot(struct sudoku *su);
+
+// sudoku_restore(su, snap) returns the board to the state sudoku_snapshot
+//   captured, undoing (or, for a token ahead of the cursor, redoing)
+//   journaled changes one by one. The function returns true on success,
+//   and false if the history the token needs is gone: the journal dropped
+//   its oldest entries, or a new change discarded the undone tail the
+//   token pointed into. Loading a new board clears the journal, so tokens
+//   taken before a load must not be used afterwards.
+// requires: snap was taken on the board su currently holds
+// effects: might mutate su
+// time: O(k) where k is the number of changes since the snapshot
+bool sudoku_restore(struct sudoku *su, long snap);
+
+// sudoku_generate(su, target_clues, seed) replaces the puzzle held by su
+//   with a freshly generated one: a random full grid is built by running the
+//   solver with candidate order shuffled by seed, then clues are removed in
+//   random order as long as the puzzle keeps a unique solution, stopping at
+//   target_clues if that few clues can be reached. The function returns the
+//   number of clues in the generated puzzle (17 is the known minimum, so
+//   smaller targets are never reached).
+// requires: target_clues is positive
+// effects: mutates *su
+int sudoku_generate(struct sudoku *su, int target_clues, unsigned int seed);
+
+// sudoku_solve_restart(su, seed) solves the Sudoku puzzle like sudoku_solve,
+//   but tries the candidates of every branch cell in an order shuffled by
+//   seed and abandons a run once its backtrack budget is spent, retrying
+//   with a fresh shuffle. Budgets follow the Luby sequence (64, 64, 128,
+//   64, ...), the classic policy for cutting off the heavy tail of
+//   order-dependent backtracking runtimes; a run that exhausts the search
+//   space within its budget makes the answer definitive. The function
+//   returns true if su has a valid solution, and false otherwise.
+// effects: might mutate *su
+bool sudoku_solve_restart(struct sudoku *su, unsigned int seed);
+
+// sudoku_count_solutions(su, limit) counts the solutions of the puzzle by
+//   continuing the backtracking search past the first solution, stopping as
+//   soon as limit solutions have been found. The function returns the
+//   number of solutions found (at most limit); calling it with limit 2 is
+//   the cheap way to distinguish unsolvable, unique, and ambiguous puzzles.
+//   The board is restored to its state before the call.
+// requires: limit is positive
+// effects: might mutate *su during the search (restored on return)
+// time: O(n^2) per solution up to limit
+int sudoku_count_solutions(struct sudoku *su, int limit);
+
+// sudoku_cache_init(entries) preallocates the transposition cache: a
+//   fixed-size, open-addressed table remembering board states the search
+//   has proven unsolvable, keyed by an incrementally maintained Zobrist
+//   hash. Every solver and the solution counter consult it, so workloads
+//   that re-solve near-identical boards (uniqueness checking during
+//   generation above all) stop rediscovering the same dead ends. The table
+//   is shared by all boards and threads; entries is rounded down to a
+//   power of two. The function returns true on success, and false if the
+//   memory could not be allocated. Without this call the cache costs one
+//   NULL test per search node.
+// requires: entries is positive
+// effects: allocates memory (client must call sudoku_cache_free)
+bool sudoku_cache_init(long entries);
+
+// sudoku_cache_free() releases the transposition cache and turns caching
+//   back off.
+// effects: frees memory
+void sudoku_cache_free(void);
+
+// a rating classifies a puzzle by the techniques one solve needed, so
+//   puzzles can be bucketed for players without an external rater
+// SUDOKU_RATING_UNSOLVABLE: the puzzle has no solution
+#define SUDOKU_RATING_UNSOLVABLE (-1)
+// SUDOKU_RATING_SINGLES: naked and hidden singles alone finish the board
+#define SUDOKU_RATING_SINGLES 0
+// SUDOKU_RATING_EASY: branching is needed, but no guess is ever undone
+#define SUDOKU_RATING_EASY 1
+// SUDOKU_RATING_MEDIUM: the search backtracks, but no more than 64 times
+#define SUDOKU_RATING_MEDIUM 2
+// SUDOKU_RATING_HARD: the search backtracks more than 64 times
+#define SUDOKU_RATING_HARD 3
+
+// sudoku_rate(su) solves a scratch copy of su under instrumentation and
+//   classifies the puzzle by the effort the solve needed, returning one of
+//   the SUDOKU_RATING codes above; su itself is left untouched. Under
+//   SUDOKU_NOSTATS the counters stay zero, so every solvable puzzle rates
+//   as singles and only unsolvability is still detected.
+// effects: allocates and frees scratch memory
+int sudoku_rate(struct sudoku *su);
+
+// sudoku_profile_print() prints the hot-path profile accumulated on the
+//   calling thread since startup (or the last reset): per site, the number
+//   of calls, the elapsed ticks, the ticks per call, and a bar showing the
+//   site's share of the measured time. The hooks only exist when the
+//   library is built with -DSUDOKU_PROFILE; otherwise the function prints
+//   a note saying profiling is not compiled in.
+// effects: produces output
+void sudoku_profile_print(void);
+
+// sudoku_profile_reset() clears the calling thread's profile counters, so
+//   the next dump covers only the work done after this call. Does nothing
+//   when profiling is not compiled in.
+void sudoku_profile_reset(void);
+
+// sudoku_rating_name(rating) returns the printable name of a rating code.
+// time: O(1)
+const char *sudoku_rating_name(int rating);
+
+// a sudoku_stats holds counters describing the work one solve performed, so
+//   slow puzzles can be diagnosed (branching factor vs. dead-end density)
+//   instead of treating the solver as a black box
+struct sudoku_stats {
+  // nodes is the number of search levels entered
+  long long nodes;
+  // backtracks is the number of guesses that had to be undone
+  long long backtracks;
+  // choice_calls is the number of cell_choices invocations
+  long long choice_calls;
+  // propagation_passes is the number of fixpoint passes made by the
+  //   naked/hidden-single propagation stage
+  long long propagation_passes;
+  // max_depth is the deepest search level reached
+  int max_depth;
+  // wall_usec is the wall-clock time the solve took, in microseconds
+  long long wall_usec;
+};
+
+// sudoku_solve_stats(su, stats) behaves exactly like sudoku_solve but fills
+//   stats with counters describing the search. Solving through the plain
+//   sudoku_solve entry point leaves the counters untouched, so the
+//   instrumentation costs nothing when it is not requested; defining
+//   SUDOKU_NOSTATS at compile time removes the counting code entirely.
+// requires: stats is a valid pointer
+// effects: might mutate *su
+//          mutates *stats
+bool sudoku_solve_stats(struct sudoku *su, struct sudoku_stats *stats);
+
+// a bounded solve (see sudoku_solve_bounded) ends in one of three ways
+// SUDOKU_UNSOLVABLE: the search space is exhausted and there is no solution
+#define SUDOKU_UNSOLVABLE 0
+// SUDOKU_SOLVED: the board now holds a valid solution
+#define SUDOKU_SOLVED 1
+// SUDOKU_TIMEOUT: the node budget ran out before the search finished
+#define SUDOKU_TIMEOUT 2
+
+// sudoku_search holds the paused state of a bounded solve so it can be
+//   resumed by a later call
+struct sudoku_search;
+
+// sudoku_search_size() returns the number of bytes of storage one
+//   sudoku_search needs, so callers can place the state wherever they like
+//   (mirroring sudoku_size).
+// time: O(1)
+int sudoku_search_size(void);
+
+// sudoku_search_begin(state) readies state for a fresh bounded solve,
+//   discarding any search it held before.
+// requires: state is a valid pointer to at least sudoku_search_size() bytes
+// effects: mutates *state
+void sudoku_search_begin(struct sudoku_search *state);
+
+// sudoku_solve_bounded(su, max_nodes, state) runs the same search as
+//   sudoku_solve_iter, but gives up after max_nodes search steps so a
+//   latency deadline can be met even on adversarial puzzles. The function
+//   returns SUDOKU_SOLVED or SUDOKU_UNSOLVABLE when the search finishes,
+//   and SUDOKU_TIMEOUT when the budget runs out first. With a non-NULL
+//   state the paused search (and the board's partial fills) survive a
+//   timeout, and the next call with the same su and state resumes where it
+//   stopped; with a NULL state a timeout undoes all fills, returning the
+//   board unchanged.
+// requires: max_nodes is positive
+//           state was set up with sudoku_search_begin (or is NULL)
+//           on resumption, su has not been mutated since the timeout
+// effects: might mutate *su and *state
+int sudoku_solve_bounded(struct sudoku *su, long long max_nodes,
+                         struct sudoku_search *state);
+
+// sudoku_solve_iter(su) solves the Sudoku puzzle using the same search and
+//   backtracking as sudoku_solve, but drives it with an explicit decision
+//   stack instead of recursion, so the memory used by the search is a fixed
+//   preallocated array rather than an unbounded call stack. The function
+//   returns true if su has a valid solution, and false otherwise. The one
+//   remaining difference from sudoku_solve is that the opt-in unsolvability
+//   cache of sudoku_cache_init is only consulted by the recursive solver.
+// effects: might mutate *su
+// time: O(n^2)
+bool sudoku_solve_iter(struct sudoku *su);
+
+#endif
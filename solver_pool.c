@@ -0,0 +1,383 @@
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "solver_pool.h"
+#include "resultring.h"
+
+// === GLOBAL READONLY =====================================================
+
+// MAX_WORKERS is the largest number of worker threads a pool may have
+#define MAX_WORKERS 32
+// QUEUE_CAP is the capacity of each per-worker queue; it bounds the number
+//   of in-flight puzzles to MAX_WORKERS * QUEUE_CAP
+#define QUEUE_CAP 64
+
+// a task is one puzzle waiting to be solved; id is its caller-visible
+//   number for error messages, seq its contiguous ordering number, and
+//   record the submitter's position marker carried through to progress
+//   reporting
+struct task {
+  struct sudoku *su;
+  int id;
+  long seq;
+  long record;
+};
+
+// a worker owns a bounded queue of tasks; both the worker and thieves take
+//   from the top (the oldest task). Taking oldest-first everywhere keeps
+//   each queue in sequence order, which bounds how far completions can run
+//   ahead of the writer: the oldest unprinted result is always the next
+//   task of some worker, never buried under newer submissions, so the
+//   completion ring can never fill up around it and deadlock the pool
+struct worker {
+  struct task tasks[QUEUE_CAP];
+  // top and bottom are indices into tasks (top <= bottom); the deque holds
+  //   the tasks in [top, bottom)
+  int top;
+  int bottom;
+  pthread_t thread;
+  pthread_mutex_t lock;
+};
+
+struct solver_pool {
+  struct worker workers[MAX_WORKERS];
+  int num_workers;
+  // done is set once all puzzles have been submitted
+  bool done;
+  // compact selects the one-line output format for solved boards
+  bool compact;
+  // pending counts submitted tasks that no worker has taken yet; workers only
+  //   sleep while it is zero, so a submission cannot slip past a worker that
+  //   is about to wait
+  int pending;
+  // next_seq numbers submissions contiguously; only the submitting thread
+  //   touches it
+  long next_seq;
+  // ring carries finished puzzles to the writer thread, which drains them
+  //   in submission order without taking any lock
+  struct result_ring *ring;
+  pthread_t writer;
+  // writer_stop tells the writer that the workers have been joined, so once
+  //   the ring runs dry nothing more is coming
+  atomic_bool writer_stop;
+  // last_record is the record marker of the last result the writer has
+  //   printed (or -1 while nothing is printed), and solved counts the
+  //   printed results that had a solution; they are atomic so the
+  //   submitting thread can read a consistent progress snapshot mid-run
+  atomic_long last_record;
+  atomic_int solved;
+  // lock protects done and pending; work signals workers that new
+  //   tasks (or the done flag) arrived, and space (signalled under lock
+  //   whenever a worker takes a task) tells the submitter a queue drained
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t space;
+};
+
+// worker_pop(w, t) takes the oldest task from w's own queue and stores it
+//   in t. The function returns true if a task was taken, and false if the
+//   queue is empty. Popping newest-first would be cache-friendlier, but it
+//   lets an old task starve under a constantly refilled queue, and the
+//   ordered writer stage cannot tolerate unbounded starvation (see the
+//   struct worker comment above).
+// effects: might mutate w and t
+static bool worker_pop(struct worker *w, struct task *t) {
+  assert(w);
+  assert(t);
+
+  bool taken = false;
+  pthread_mutex_lock(&w->lock);
+  if (w->top < w->bottom) {
+    *t = w->tasks[w->top];
+    ++w->top;
+    taken = true;
+  }
+  pthread_mutex_unlock(&w->lock);
+  return taken;
+}
+
+// worker_steal(w, t) takes the oldest task from the victim w's queue and
+//   stores it in t. The function returns true if a task was taken, and false
+//   if the queue is empty.
+// effects: might mutate w and t
+static bool worker_steal(struct worker *w, struct task *t) {
+  assert(w);
+  assert(t);
+
+  bool taken = false;
+  pthread_mutex_lock(&w->lock);
+  if (w->top < w->bottom) {
+    *t = w->tasks[w->top];
+    ++w->top;
+    taken = true;
+  }
+  pthread_mutex_unlock(&w->lock);
+  return taken;
+}
+
+// worker_take(pool, self, t) finds the next task for worker self: first from
+//   its own deque, then by stealing from the other workers. The function
+//   returns true if a task was found, and false otherwise.
+// effects: might mutate pool and t
+static bool worker_take(struct solver_pool *pool, int self, struct task *t) {
+  assert(pool);
+  assert(t);
+
+  if (worker_pop(&pool->workers[self], t)) {
+    return true;
+  }
+
+  // scan the other workers starting after self so thieves spread out instead
+  //   of all hammering worker 0
+  for (int i = 1; i < pool->num_workers; ++i) {
+    int victim = (self + i) % pool->num_workers;
+    if (worker_steal(&pool->workers[victim], t)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// an argument bundle for worker_main, since pthreads passes a single pointer
+struct worker_arg {
+  struct solver_pool *pool;
+  int index;
+};
+
+// worker_main(arg) is the body of one worker thread: it takes tasks (own
+//   queue first, stealing otherwise), solves them, and prints the results.
+// effects: produces output
+//          mutates the pool
+static void *worker_main(void *arg) {
+  assert(arg);
+  struct worker_arg *wa = arg;
+  struct solver_pool *pool = wa->pool;
+  int self = wa->index;
+  free(wa);
+
+  while (1) {
+    struct task t = { NULL, 0, 0, 0 };
+
+    if (!worker_take(pool, self, &t)) {
+      // no work anywhere: either wait for more submissions or exit once the
+      //   submitter is done and every task has been taken
+      pthread_mutex_lock(&pool->lock);
+      while (pool->pending == 0 && !pool->done) {
+        pthread_cond_wait(&pool->work, &pool->lock);
+      }
+      bool finished = (pool->pending == 0 && pool->done);
+      pthread_mutex_unlock(&pool->lock);
+      if (finished) {
+        break;
+      }
+      continue;
+    }
+
+    // space in a queue appears the moment a task is taken, not when it is
+    //   solved; signalling here under the lock pairs with the full-queue
+    //   check the submitter makes under the same lock, so a wakeup cannot
+    //   fall into the gap between that check and its wait
+    pthread_mutex_lock(&pool->lock);
+    --pool->pending;
+    pthread_cond_signal(&pool->space);
+    pthread_mutex_unlock(&pool->lock);
+
+    bool solved = sudoku_solve(t.su);
+
+    // one atomic release store hands the result to the writer stage; the
+    //   old mutex-protected printing serialized every worker here
+    result_ring_publish(pool->ring, t.seq, t.su, solved, t.id, t.record);
+  }
+
+  return NULL;
+}
+
+// writer_main(arg) is the body of the writer thread: it drains the
+//   completion ring strictly in submission order, prints each result, and
+//   frees the board.
+// effects: produces output
+//          mutates the pool
+static void *writer_main(void *arg) {
+  assert(arg);
+  struct solver_pool *pool = arg;
+
+  while (1) {
+    struct sudoku *su = NULL;
+    bool solved = false;
+    int id = 0;
+    long record = 0;
+
+    if (result_ring_take(pool->ring, &su, &solved, &id, &record)) {
+      if (solved) {
+        ++pool->solved;
+        if (pool->compact) {
+          solution_print_compact(su);
+        } else {
+          solution_print(su);
+        }
+      } else {
+        printf("Could not solve puzzle %d using search and backtracking :(\n",
+               id);
+      }
+      sudoku_destroy(su);
+      // advance the marker only after the output is written, so a progress
+      //   reader never sees a record as done before it is printed
+      atomic_store(&pool->last_record, record);
+      continue;
+    }
+
+    if (atomic_load(&pool->writer_stop)) {
+      // the workers are gone and the ring is dry: every result is out
+      break;
+    }
+    sched_yield();
+  }
+
+  return NULL;
+}
+
+// see solver_pool.h for documentation
+struct solver_pool *solver_pool_create(int threads, bool compact) {
+  assert(threads > 0);
+  if (threads > MAX_WORKERS) {
+    threads = MAX_WORKERS;
+  }
+
+  struct solver_pool *pool = malloc(sizeof(struct solver_pool));
+  assert(pool);
+  pool->num_workers = threads;
+  pool->done = false;
+  pool->compact = compact;
+  pool->pending = 0;
+  pool->next_seq = 0;
+  pool->ring = result_ring_create();
+  atomic_init(&pool->writer_stop, false);
+  atomic_init(&pool->last_record, -1);
+  atomic_init(&pool->solved, 0);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work, NULL);
+  pthread_cond_init(&pool->space, NULL);
+  assert(pthread_create(&pool->writer, NULL, writer_main, pool) == 0);
+
+  // initialize every deque (and its mutex) before any worker runs: a worker
+  //   spawned early steal-scans all of its siblings, so no worker may start
+  //   while another worker's queue is still malloc garbage
+  for (int i = 0; i < threads; ++i) {
+    struct worker *w = &pool->workers[i];
+    w->top = 0;
+    w->bottom = 0;
+    pthread_mutex_init(&w->lock, NULL);
+  }
+
+  for (int i = 0; i < threads; ++i) {
+    struct worker_arg *wa = malloc(sizeof(struct worker_arg));
+    assert(wa);
+    wa->pool = pool;
+    wa->index = i;
+    assert(pthread_create(&pool->workers[i].thread, NULL, worker_main, wa) ==
+           0);
+  }
+
+  return pool;
+}
+
+// see solver_pool.h for documentation
+void solver_pool_submit(struct solver_pool *pool, struct sudoku *su, int id,
+                        long record) {
+  assert(pool);
+  assert(su);
+  assert(record >= 0);
+
+  // puzzles go to the workers round-robin by sequence number; the per-worker
+  //   imbalance this causes is exactly what stealing evens out
+  struct worker *w = &pool->workers[id % pool->num_workers];
+
+  // pool->lock is held from the full-queue check through the wait, and a
+  //   worker signals space under the same lock when it takes a task, so a
+  //   take cannot slip unseen between the check and the wait. Workers never
+  //   hold a deque lock while acquiring pool->lock, so nesting the deque
+  //   lock inside pool->lock here cannot deadlock.
+  pthread_mutex_lock(&pool->lock);
+  while (1) {
+    pthread_mutex_lock(&w->lock);
+    if (w->bottom - w->top < QUEUE_CAP) {
+      // compact the deque when the indices reach the end of the array; this
+      //   is O(QUEUE_CAP) but happens at most once per QUEUE_CAP submissions
+      if (w->bottom == QUEUE_CAP) {
+        for (int i = w->top; i < w->bottom; ++i) {
+          w->tasks[i - w->top] = w->tasks[i];
+        }
+        w->bottom -= w->top;
+        w->top = 0;
+      }
+      w->tasks[w->bottom].su = su;
+      w->tasks[w->bottom].id = id;
+      w->tasks[w->bottom].record = record;
+      ++pool->next_seq;
+      w->tasks[w->bottom].seq = pool->next_seq;
+      ++w->bottom;
+      pthread_mutex_unlock(&w->lock);
+
+      ++pool->pending;
+      pthread_cond_broadcast(&pool->work);
+      pthread_mutex_unlock(&pool->lock);
+      return;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    // the target queue is full: wait until some worker takes a task
+    pthread_cond_wait(&pool->space, &pool->lock);
+  }
+}
+
+// see solver_pool.h for documentation
+void solver_pool_progress(struct solver_pool *pool, long *last_record,
+                          int *solved) {
+  assert(pool);
+  assert(last_record);
+  assert(solved);
+
+  // read solved before last_record: the writer bumps solved first and the
+  //   marker last, so this order can only see a solved count at or below
+  //   the printed prefix it is paired with, never more solutions than
+  //   finished puzzles
+  *solved = atomic_load(&pool->solved);
+  *last_record = atomic_load(&pool->last_record);
+}
+
+// see solver_pool.h for documentation
+int solver_pool_finish(struct solver_pool *pool) {
+  assert(pool);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->done = true;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  // join every worker before destroying any deque mutex: a worker that is
+  //   still draining steal-scans all of its siblings, including ones whose
+  //   threads have already been joined
+  for (int i = 0; i < pool->num_workers; ++i) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  for (int i = 0; i < pool->num_workers; ++i) {
+    pthread_mutex_destroy(&pool->workers[i].lock);
+  }
+
+  // all publications happened before the joins above, so once the writer
+  //   sees the stop flag and an empty ring it has printed everything
+  atomic_store(&pool->writer_stop, true);
+  pthread_join(pool->writer, NULL);
+
+  int solved = atomic_load(&pool->solved);
+  result_ring_destroy(pool->ring);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work);
+  pthread_cond_destroy(&pool->space);
+  free(pool);
+  return solved;
+}
@@ -0,0 +1,56 @@
+#ifndef SOLVER_POOL_H
+#define SOLVER_POOL_H
+
+#include <stdbool.h>
+#include "sudoku.h"
+
+// A solver pool shards puzzles across worker threads, each solving with its
+//   own boards, with work stealing so one pathological puzzle does not idle
+//   the other workers. Finished puzzles flow through the lock-free
+//   completion ring of resultring.h to a dedicated writer thread, so
+//   results are printed in submission order and workers never serialize on
+//   an output lock.
+struct solver_pool;
+
+// solver_pool_create(threads, compact) creates a pool with the given number
+//   of worker threads and starts them. If compact is true, solutions are
+//   printed in the one-line format of solution_print_compact; otherwise the
+//   drawn board of solution_print is used.
+// requires: threads must be positive
+// effects: allocates memory (client must call solver_pool_finish)
+//          starts threads
+struct solver_pool *solver_pool_create(int threads, bool compact);
+
+// solver_pool_submit(pool, su, id, record) hands the puzzle su (with
+//   sequence number id) to the pool; record is the caller's position marker
+//   for the puzzle (e.g. its corpus record index), carried through to
+//   solver_pool_progress. Ownership of su passes to the pool, which
+//   destroys it after solving. The function blocks while all worker queues
+//   are full, so the number of in-flight puzzles stays bounded.
+// requires: pool and su are valid pointers
+//           record is non-negative
+// effects: mutates pool
+//          might block
+void solver_pool_submit(struct solver_pool *pool, struct sudoku *su, int id,
+                        long record);
+
+// solver_pool_progress(pool, last_record, solved) reports the record
+//   marker of the last result printed so far (-1 while nothing is printed)
+//   and how many printed results had a solution. Results are printed in
+//   submission order, so every submission up to and including that marker
+//   is fully done. Safe to call from the submitting thread while the pool
+//   runs.
+// requires: pool, last_record, and solved are valid pointers
+// effects: mutates *last_record and *solved
+void solver_pool_progress(struct solver_pool *pool, long *last_record,
+                          int *solved);
+
+// solver_pool_finish(pool) waits until all submitted puzzles are solved,
+//   stops the workers, frees the pool, and returns the number of puzzles
+//   that had a solution.
+// requires: pool is a valid pointer
+// effects: pool is no longer valid
+//          produces output
+int solver_pool_finish(struct solver_pool *pool);
+
+#endif
@@ -0,0 +1,170 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "speculate.h"
+
+// === GLOBAL READONLY =====================================================
+
+// SPEC_MAX_WORKERS is the most threads one puzzle can use: a cell never has
+//   more than nine candidates, so more threads would sit idle
+#define SPEC_MAX_WORKERS 9
+
+// SPEC_SLICE is the node budget of one bounded-solve slice; between slices
+//   a worker checks whether another thread already won, so the slice size
+//   bounds how long a loser keeps searching a dead subtree
+#define SPEC_SLICE 2048
+
+// a spec_worker describes the slice of the candidate set one thread owns
+struct spec_worker {
+  // start is the shared board with the branch cell still empty; workers
+  //   only read it
+  const struct sudoku *start;
+  // pos is the position of the branch cell
+  int pos;
+  // candidates and num_candidates list every candidate of the branch cell;
+  //   this worker explores the ones whose index is id modulo the number of
+  //   workers
+  const int *candidates;
+  int num_candidates;
+  int id;
+  int num_workers;
+  // winner holds the candidate index of the first thread to find a
+  //   solution, or -1 while the race is still open
+  atomic_int *winner;
+  // result is this worker's private board; when won is true it holds the
+  //   solution
+  struct sudoku *result;
+  bool won;
+};
+
+// spec_main(arg) is the body of one speculative thread: it searches its
+//   candidate subtrees in bounded slices, checking between slices whether
+//   another thread already found a solution.
+// effects: mutates the worker
+static void *spec_main(void *arg) {
+  assert(arg);
+  struct spec_worker *w = arg;
+
+  // define and initialize this thread's resumable search state
+  struct sudoku_search *state = malloc(sudoku_search_size());
+  assert(state);
+
+  for (int i = w->id; i < w->num_candidates; i += w->num_workers) {
+    if (atomic_load(w->winner) >= 0) {
+      break;
+    }
+
+    // clone the shared board and commit this subtree's candidate
+    memcpy(w->result, w->start, sudoku_size());
+    if (!cell_fill(w->result, w->pos / 9, w->pos % 9, w->candidates[i])) {
+      continue;
+    }
+
+    sudoku_search_begin(state);
+    // define and initialize the outcome of the search below the candidate
+    int rc = SUDOKU_TIMEOUT;
+    while (rc == SUDOKU_TIMEOUT && atomic_load(w->winner) < 0) {
+      rc = sudoku_solve_bounded(w->result, SPEC_SLICE, state);
+    }
+
+    if (rc == SUDOKU_SOLVED) {
+      // define and initialize the expected open-race value; only the thread
+      //   whose exchange succeeds may publish its board
+      int expected = -1;
+      if (atomic_compare_exchange_strong(w->winner, &expected, i)) {
+        w->won = true;
+      }
+      break;
+    }
+  }
+
+  free(state);
+  return NULL;
+}
+
+// see speculate.h for documentation
+bool sudoku_solve_parallel(struct sudoku *su, int threads) {
+  assert(su);
+  assert(threads > 0);
+
+  if (puzzle_solved(su)) {
+    return true;
+  }
+
+  // find the first branch point: the empty cell with the fewest candidates,
+  //   exactly as least_possible_solutions does inside the solver
+  int pos = -1;
+  int candidates[9];
+  int num_candidates = 10;
+  for (int row = 0; row < 9 && num_candidates > 2; ++row) {
+    for (int col = 0; col < 9 && num_candidates > 2; ++col) {
+      // define and initialize the candidates of the current cell
+      int choices[9];
+      int n = cell_choices(su, row, col, choices);
+
+      if (n == 0) {
+        continue;
+      }
+      if (n < num_candidates) {
+        num_candidates = n;
+        pos = row * 9 + col;
+        memcpy(candidates, choices, sizeof(choices));
+      }
+    }
+  }
+
+  if (pos == -1) {
+    // every empty cell is a dead end (or there are none): nothing to race on
+    return sudoku_solve(su);
+  }
+  if (threads == 1 || num_candidates == 1) {
+    // a forced cell gives the race only one lane; speculation cannot help
+    return sudoku_solve(su);
+  }
+
+  // define and initialize the number of worker threads: one per candidate,
+  //   capped by the caller's budget
+  int num_workers = num_candidates;
+  if (num_workers > threads) {
+    num_workers = threads;
+  }
+  if (num_workers > SPEC_MAX_WORKERS) {
+    num_workers = SPEC_MAX_WORKERS;
+  }
+
+  // define and initialize the first-winner flag the threads race on
+  atomic_int winner = -1;
+
+  struct spec_worker workers[SPEC_MAX_WORKERS];
+  pthread_t tids[SPEC_MAX_WORKERS];
+  for (int i = 0; i < num_workers; ++i) {
+    workers[i].start = su;
+    workers[i].pos = pos;
+    workers[i].candidates = candidates;
+    workers[i].num_candidates = num_candidates;
+    workers[i].id = i;
+    workers[i].num_workers = num_workers;
+    workers[i].winner = &winner;
+    workers[i].result = malloc(sudoku_size());
+    assert(workers[i].result);
+    workers[i].won = false;
+    assert(pthread_create(&tids[i], NULL, spec_main, &workers[i]) == 0);
+  }
+
+  // define and initialize the overall outcome, filled in as workers finish
+  bool solved = false;
+  for (int i = 0; i < num_workers; ++i) {
+    pthread_join(tids[i], NULL);
+  }
+  for (int i = 0; i < num_workers; ++i) {
+    if (workers[i].won) {
+      memcpy(su, workers[i].result, sudoku_size());
+      solved = true;
+    }
+    free(workers[i].result);
+  }
+
+  return solved;
+}
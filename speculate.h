@@ -0,0 +1,26 @@
+#ifndef SPECULATE_H
+#define SPECULATE_H
+
+#include <stdbool.h>
+#include "sudoku.h"
+
+// The work-stealing pool in solver_pool.c spreads many puzzles across
+//   threads, which does nothing for one pathological puzzle that is the
+//   long pole of a batch. sudoku_solve_parallel attacks a single puzzle
+//   from the inside: each candidate of the first branch cell is explored
+//   by its own thread on a cloned board, and the first thread to find a
+//   solution wins while the others stop at their next budget check.
+
+// sudoku_solve_parallel(su, threads) solves su like sudoku_solve, but
+//   splits the search at the first branch point: the empty cell with the
+//   fewest candidates is found, each candidate subtree is searched by a
+//   separate thread on its own copy of the board, and the first solution
+//   found is copied back into su. Losing threads notice the winner at
+//   their next node-budget check and abandon their subtrees. The function
+//   returns true if su has a valid solution, and false otherwise. With one
+//   thread (or a forced cell) it falls back to the sequential solver.
+// requires: threads is positive
+// effects: might mutate *su
+bool sudoku_solve_parallel(struct sudoku *su, int threads);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SUDOKU_ANY_H
+#define SUDOKU_ANY_H
+
+#include <stdbool.h>
+
+// The interactive engine in soduku.c is specialized for 9x9 boards: its
+//   text format, undo journal, and hint cache only make sense there. The
+//   functions below expose the solving kernel alone for the other board
+//   sizes clients ask for. All three are stamped from the one template in
+//   sudoku_any.inc with the dimension, box size, and mask width fixed at
+//   compile time, so each variant has constant loop bounds and fixed-size
+//   arrays exactly as if it had been written by hand for its size.
+//
+// A board is a flat array of cells in reading order, one byte per cell:
+//   0 for an empty cell, and 1 to N for a placed number.
+
+// sudoku_solve_9(cells) solves the 9x9 board in cells in place using
+//   search and backtracking. The function returns true if cells now holds
+//   a valid solution, and false if the givens conflict or no solution
+//   exists (cells is left unchanged on failure).
+// requires: cells is a valid array of 81 cells
+// effects: might mutate cells
+bool sudoku_solve_9(unsigned char cells[]);
+
+// sudoku_solve_16(cells) behaves like sudoku_solve_9 for a 16x16 board
+//   (256 cells, values 1 to 16, boxes of 4x4).
+// requires: cells is a valid array of 256 cells
+// effects: might mutate cells
+bool sudoku_solve_16(unsigned char cells[]);
+
+// sudoku_solve_25(cells) behaves like sudoku_solve_9 for a 25x25 board
+//   (625 cells, values 1 to 25, boxes of 5x5).
+// requires: cells is a valid array of 625 cells
+// effects: might mutate cells
+bool sudoku_solve_25(unsigned char cells[]);
+
+#endif
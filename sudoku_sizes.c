@@ -0,0 +1,21 @@
+#include <assert.h>
+#include <stdint.h>
+#include "sudoku_any.h"
+
+// Each include below stamps one fully specialized solver from the shared
+//   template; see sudoku_any.inc for the parameter contract.
+
+#define SUD_DIM 9
+#define SUD_DIMBOX 3
+#define SUD_MASK uint16_t
+#include "sudoku_any.inc"
+
+#define SUD_DIM 16
+#define SUD_DIMBOX 4
+#define SUD_MASK uint32_t
+#include "sudoku_any.inc"
+
+#define SUD_DIM 25
+#define SUD_DIMBOX 5
+#define SUD_MASK uint32_t
+#include "sudoku_any.inc"